@@ -0,0 +1,231 @@
+#include "allocstats.h"
+
+#ifdef SNAKE_INSTRUMENTATION
+
+#include <new>
+#include <cstdlib>
+#include <iomanip>
+#include <stdexcept>
+#include <string>
+
+AllocStats::ThreadCounts AllocStats::fallbackCounts{{0}, {0}, {0}, nullptr};
+std::atomic<AllocStats::ThreadCounts*> AllocStats::threadCountsHead{&AllocStats::fallbackCounts};
+AllocStats::RegionStats AllocStats::regionStats[(unsigned int) AllocStats::Region::Count];
+AllocStats::Counts AllocStats::generationStart{0, 0, 0};
+
+/**
+ *  With glibc, the C allocation functions are replaced too (forwarding to glibc's own implementation), as Eigen allocates
+ * its matrices and vectors through std::malloc. The replaced operator new/delete then call glibc's implementation directly,
+ * so that C++ allocations aren't counted twice. With any other C library, only the C++ allocations are counted.
+ */
+#ifdef __GLIBC__
+extern "C" {
+void* __libc_malloc(std::size_t size);
+void* __libc_calloc(std::size_t count, std::size_t size);
+void* __libc_realloc(void *ptr, std::size_t size);
+void* __libc_memalign(std::size_t alignment, std::size_t size);
+void __libc_free(void *ptr);
+
+void* malloc(std::size_t size) noexcept {
+  AllocStats::CountAlloc(size);
+  return __libc_malloc(size);
+}
+
+void* calloc(std::size_t count, std::size_t size) noexcept {
+  AllocStats::CountAlloc(count * size);
+  return __libc_calloc(count, size);
+}
+
+void* realloc(void *ptr, std::size_t size) noexcept {
+  // A reallocation counts as a new allocation (and the free of the previous one, if any).
+  if (size > 0) AllocStats::CountAlloc(size);
+  if (ptr != nullptr) AllocStats::CountFree();
+  return __libc_realloc(ptr, size);
+}
+
+void free(void *ptr) noexcept {
+  if (ptr != nullptr) AllocStats::CountFree();
+  __libc_free(ptr);
+}
+}
+
+#define RAW_MALLOC(size) __libc_malloc(size)
+#define RAW_ALIGNED_ALLOC(alignment, size) __libc_memalign(alignment, size)
+#define RAW_FREE(ptr) __libc_free(ptr)
+#else
+#define RAW_MALLOC(size) std::malloc(size)
+#define RAW_ALIGNED_ALLOC(alignment, size) std::aligned_alloc(alignment, ((size) + (alignment) - 1) / (alignment) * (alignment))
+#define RAW_FREE(ptr) std::free(ptr)
+#endif
+
+/**
+ *  \brief Allocates memory for the replaced operator new, counting the allocation. If there's not enough memory, a
+ * std::bad_alloc exception is raised, unless the nothrow flag is set (in which case nullptr is returned).
+ *  \param size The allocation size, in bytes.
+ *  \param nothrow True, for the nothrow versions of operator new.
+ *  \return The allocated memory.
+ */
+static void* CountedNew(std::size_t size, const bool nothrow) {
+  if (size == 0) size = 1;
+  AllocStats::CountAlloc(size);
+  void *ptr = RAW_MALLOC(size);
+  if (ptr == nullptr && !nothrow) throw std::bad_alloc();
+  return ptr;
+}
+
+/**
+ *  \brief Allocates memory for the replaced over-aligned operator new (used for types declared with an alignment larger
+ * than the default one, e.g. the MpscQueue indexes), counting the allocation. Same as CountedNew otherwise.
+ *  \param size The allocation size, in bytes.
+ *  \param alignment The alignment (a power of two).
+ *  \param nothrow True, for the nothrow versions of operator new.
+ *  \return The allocated memory.
+ */
+static void* CountedAlignedNew(std::size_t size, const std::align_val_t alignment, const bool nothrow) {
+  if (size == 0) size = 1;
+  AllocStats::CountAlloc(size);
+  void *ptr = RAW_ALIGNED_ALLOC((std::size_t) alignment, size);
+  if (ptr == nullptr && !nothrow) throw std::bad_alloc();
+  return ptr;
+}
+
+/**
+ *  \brief Frees memory for the replaced operator delete, counting the free.
+ *  \param ptr The memory to be freed (or nullptr).
+ */
+static void CountedDelete(void *ptr) noexcept {
+  if (ptr == nullptr) return;
+  AllocStats::CountFree();
+  RAW_FREE(ptr);
+}
+
+void* operator new(std::size_t size) { return CountedNew(size, false); }
+void* operator new[](std::size_t size) { return CountedNew(size, false); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return CountedNew(size, true); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return CountedNew(size, true); }
+void operator delete(void *ptr) noexcept { CountedDelete(ptr); }
+void operator delete[](void *ptr) noexcept { CountedDelete(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { CountedDelete(ptr); }
+void operator delete[](void *ptr, std::size_t) noexcept { CountedDelete(ptr); }
+void operator delete(void *ptr, const std::nothrow_t&) noexcept { CountedDelete(ptr); }
+void operator delete[](void *ptr, const std::nothrow_t&) noexcept { CountedDelete(ptr); }
+
+void* operator new(std::size_t size, std::align_val_t alignment) { return CountedAlignedNew(size, alignment, false); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return CountedAlignedNew(size, alignment, false); }
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+  return CountedAlignedNew(size, alignment, true);
+}
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+  return CountedAlignedNew(size, alignment, true);
+}
+void operator delete(void *ptr, std::align_val_t) noexcept { CountedDelete(ptr); }
+void operator delete[](void *ptr, std::align_val_t) noexcept { CountedDelete(ptr); }
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept { CountedDelete(ptr); }
+void operator delete[](void *ptr, std::size_t, std::align_val_t) noexcept { CountedDelete(ptr); }
+void operator delete(void *ptr, std::align_val_t, const std::nothrow_t&) noexcept { CountedDelete(ptr); }
+void operator delete[](void *ptr, std::align_val_t, const std::nothrow_t&) noexcept { CountedDelete(ptr); }
+
+void AllocStats::Budget::Check() const {
+  const Counts counts = scope.Get();
+  if (counts.allocCnt > maxAllocCnt) {
+    throw std::runtime_error("Allocation budget exceeded in " + std::string(region) + ": " + std::to_string(counts.allocCnt)
+                             + " allocations (" + std::to_string(counts.byteCnt) + " bytes), for a budget of "
+                             + std::to_string(maxAllocCnt) + ".");
+  }
+}
+
+AllocStats::ThreadCounts& AllocStats::GetThreadCounters() {
+  thread_local ThreadCounts *counters = nullptr;
+  if (counters == nullptr) {
+    // The counters are allocated straight from the C library (as counting their own allocation would recurse here), and
+    // pushed to the head of the list. This is reached from the replaced allocation functions (including the C ones, which
+    // must not throw), so if the memory can't be allocated, the thread counts into the shared fallback counters instead.
+    void *memory = RAW_MALLOC(sizeof(ThreadCounts));
+    if (memory == nullptr) return fallbackCounts;
+    counters = new (memory) ThreadCounts{{0}, {0}, {0}, threadCountsHead.load(std::memory_order_relaxed)};
+    while (!threadCountsHead.compare_exchange_weak(counters->next, counters, std::memory_order_release,
+                                                   std::memory_order_relaxed)) {}
+  }
+  return *counters;
+}
+
+void AllocStats::CountAlloc(const std::size_t size) {
+  // Only the owner thread writes its counters, so plain loads and stores are enough.
+  ThreadCounts& counters = GetThreadCounters();
+  counters.allocCnt.store(counters.allocCnt.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  counters.byteCnt.store(counters.byteCnt.load(std::memory_order_relaxed) + size, std::memory_order_relaxed);
+}
+
+void AllocStats::CountFree() {
+  ThreadCounts& counters = GetThreadCounters();
+  counters.freeCnt.store(counters.freeCnt.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+AllocStats::Counts AllocStats::GetThreadCounts() {
+  const ThreadCounts& counters = GetThreadCounters();
+  return Counts{counters.allocCnt.load(std::memory_order_relaxed), counters.byteCnt.load(std::memory_order_relaxed),
+                counters.freeCnt.load(std::memory_order_relaxed)};
+}
+
+AllocStats::Counts AllocStats::GetTotalCounts() {
+  Counts total{0, 0, 0};
+  for (ThreadCounts *counters = threadCountsHead.load(std::memory_order_acquire); counters != nullptr;
+       counters = counters->next) {
+    total.allocCnt += counters->allocCnt.load(std::memory_order_relaxed);
+    total.byteCnt += counters->byteCnt.load(std::memory_order_relaxed);
+    total.freeCnt += counters->freeCnt.load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+void AllocStats::Record(const AllocStats::Region region, const AllocStats::Counts& counts) {
+  // Regions may be recorded by several threads at once (e.g. the training workers' games).
+  RegionStats& stats = regionStats[(unsigned int) region];
+  stats.runCnt.fetch_add(1, std::memory_order_relaxed);
+  stats.allocCnt.fetch_add(counts.allocCnt, std::memory_order_relaxed);
+  stats.byteCnt.fetch_add(counts.byteCnt, std::memory_order_relaxed);
+  uint64_t max = stats.maxAllocCnt.load(std::memory_order_relaxed);
+  while (counts.allocCnt > max && !stats.maxAllocCnt.compare_exchange_weak(max, counts.allocCnt, std::memory_order_relaxed)) {}
+  max = stats.maxByteCnt.load(std::memory_order_relaxed);
+  while (counts.byteCnt > max && !stats.maxByteCnt.compare_exchange_weak(max, counts.byteCnt, std::memory_order_relaxed)) {}
+}
+
+void AllocStats::RecordGeneration() {
+  const Counts total = GetTotalCounts();
+  Record(Region::Generation, total - generationStart);
+  generationStart = total;
+}
+
+void AllocStats::Dump(std::ostream& stream) {
+  const Counts total = GetTotalCounts();
+  const std::ios_base::fmtflags flags = stream.flags();
+  const std::streamsize precision = stream.precision();
+  stream << "Allocations: " << total.allocCnt << " (" << total.byteCnt << " bytes), frees: " << total.freeCnt << "\n"
+         << std::left << std::setw(22) << "region" << std::right << std::setw(12) << "runs" << std::setw(14) << "mean allocs"
+         << std::setw(12) << "max allocs" << std::setw(14) << "mean bytes" << std::setw(14) << "max bytes" << "\n"
+         << std::fixed << std::setprecision(1);
+  for (unsigned int i = 0; i < (unsigned int) Region::Count; i++) {
+    const RegionStats& stats = regionStats[i];
+    const uint64_t runCnt = stats.runCnt.load(std::memory_order_relaxed);
+    const double runs = (runCnt > 0)? (double) runCnt : 1.0;
+    stream << std::left << std::setw(22) << GetRegionName((Region) i) << std::right << std::setw(12) << runCnt
+           << std::setw(14) << stats.allocCnt.load(std::memory_order_relaxed) / runs
+           << std::setw(12) << stats.maxAllocCnt.load(std::memory_order_relaxed)
+           << std::setw(14) << stats.byteCnt.load(std::memory_order_relaxed) / runs
+           << std::setw(14) << stats.maxByteCnt.load(std::memory_order_relaxed) << "\n";
+  }
+  stream << std::flush;
+  stream.flags(flags);
+  stream.precision(precision);
+}
+
+const char* AllocStats::GetRegionName(const AllocStats::Region region) {
+  switch (region) {
+    case Region::Frame: return "per frame";
+    case Region::Game: return "per game";
+    case Region::Generation: return "per generation";
+    default: return "unknown";
+  }
+}
+
+#endif
@@ -0,0 +1,197 @@
+#ifndef ALLOCSTATS_H
+#define ALLOCSTATS_H
+
+/**
+ *  Heap allocation accounting, only built if SNAKE_INSTRUMENTATION is defined (see the SNAKE_INSTRUMENTATION CMake option),
+ * in which case the global operator new/delete (and, with glibc, the C allocation functions used by Eigen) are replaced by
+ * counting versions. Otherwise, the ALLOC_* macros expand to nothing.
+ */
+#ifdef SNAKE_INSTRUMENTATION
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <ostream>
+
+/**
+ *  \brief Class counting the heap allocations (and their bytes) and frees of each thread, and aggregating the allocations
+ * made per frame, per game and per generation. Each thread counts into its own counters (only written by that thread),
+ * linked into a lock-free list on the thread's first allocation, so counting never takes a lock nor allocates.
+ */
+class AllocStats {
+ public:
+  /**
+   *  \brief Allocation counts: number of allocations, total bytes allocated, and number of frees.
+   */
+  struct Counts {
+    uint64_t allocCnt;
+    uint64_t byteCnt;
+    uint64_t freeCnt;
+    AllocStats::Counts operator-(const AllocStats::Counts& other) const {
+      return Counts{allocCnt - other.allocCnt, byteCnt - other.byteCnt, freeCnt - other.freeCnt};
+    }
+  };
+
+  /**
+   *  \brief Code regions whose allocations are aggregated: a main loop frame (main thread), a game evaluated by a training
+   * worker, and a genetic algorithm generation (all threads).
+   */
+  enum class Region : uint8_t { Frame, Game, Generation, Count };
+
+  /**
+   *  \brief Scope measuring the calling thread's allocations since its construction.
+   */
+  class Scope {
+   public:
+    Scope() : start(AllocStats::GetThreadCounts()) {}
+    AllocStats::Counts Get() const { return AllocStats::GetThreadCounts() - start; }
+
+   private:
+    const AllocStats::Counts start;
+  };
+
+  /**
+   *  \brief Allocation budget of a code region (run by a single thread), e.g. to make sure a hot path never allocates.
+   */
+  class Budget {
+   public:
+    /**
+     *  \brief Constructor of the Budget class object, starting the measure of the region's allocations.
+     *  \param region The region name (a string literal), shown if the budget is exceeded.
+     *  \param maxAllocCnt Maximum number of allocations allowed in the region (usually 0).
+     */
+    Budget(const char *region, const uint64_t maxAllocCnt) : region(region), maxAllocCnt(maxAllocCnt) {}
+
+    /**
+     *  \brief Checks the allocations made since the budget's construction. If there were more than allowed, a runtime
+     * exception is raised.
+     */
+    void Check() const;
+
+   private:
+    const char *region;
+    const uint64_t maxAllocCnt;
+    const AllocStats::Scope scope;
+  };
+
+  /**
+   *  \brief Returns the calling thread's allocation counts so far.
+   *  \return The thread's counts.
+   */
+  static AllocStats::Counts GetThreadCounts();
+
+  /**
+   *  \brief Returns the allocation counts of all threads so far.
+   *  \return The total counts.
+   */
+  static AllocStats::Counts GetTotalCounts();
+
+  /**
+   *  \brief Adds the allocations made in a run of a region (from any thread) to the region's aggregate.
+   *  \param region The region.
+   *  \param counts The allocations made in the run.
+   */
+  static void Record(const AllocStats::Region region, const AllocStats::Counts& counts);
+
+  /**
+   *  \brief Adds the allocations made by all threads since the previous call (or since the start) to the generations'
+   * aggregate, at the end of a generation.
+   */
+  static void RecordGeneration();
+
+  /**
+   *  \brief Writes the total allocation counts, and the mean and maximum allocations and bytes per region run.
+   *  \param stream The output stream.
+   */
+  static void Dump(std::ostream& stream);
+
+  /**
+   *  \brief Counts an allocation, or a free, in the calling thread's counters (called by the replaced allocation functions).
+   *  \param size The allocation size, in bytes.
+   */
+  static void CountAlloc(const std::size_t size);
+  static void CountFree();
+
+ private:
+  /**
+   *  \brief Counters of a thread, and the next thread's counters in the list.
+   */
+  struct ThreadCounts {
+    std::atomic<uint64_t> allocCnt;
+    std::atomic<uint64_t> byteCnt;
+    std::atomic<uint64_t> freeCnt;
+    ThreadCounts *next;
+  };
+
+  /**
+   *  \brief Aggregate of a region's runs: number of runs, total and maximum allocations and bytes per run.
+   */
+  struct RegionStats {
+    std::atomic<uint64_t> runCnt;
+    std::atomic<uint64_t> allocCnt;
+    std::atomic<uint64_t> byteCnt;
+    std::atomic<uint64_t> maxAllocCnt;
+    std::atomic<uint64_t> maxByteCnt;
+  };
+
+  /**
+   *  \brief Returns the calling thread's counters, creating and linking them on the first call (with no allocation through
+   * the counting functions).
+   *  \return The thread's counters.
+   */
+  static AllocStats::ThreadCounts& GetThreadCounters();
+
+  /**
+   *  \brief Returns the name of a region.
+   *  \param region The region.
+   *  \return The region name.
+   */
+  static const char* GetRegionName(const AllocStats::Region region);
+
+  /**
+   *  \brief Counters shared by the threads whose own counters couldn't be allocated (always the list's tail; as several
+   * threads may write them, some of their counts may be lost).
+   */
+  static ThreadCounts fallbackCounts;
+
+  /**
+   *  \brief Head of the list of all threads' counters (which are kept after their threads end).
+   */
+  static std::atomic<ThreadCounts*> threadCountsHead;
+
+  /**
+   *  \brief Aggregates of the regions, and the total counts at the end of the previous generation.
+   */
+  static RegionStats regionStats[(unsigned int) Region::Count];
+  static AllocStats::Counts generationStart;
+};
+
+/**
+ *  \brief Measures the calling thread's allocations from this point (into a named scope variable), and adds them to a
+ * region's aggregate.
+ */
+#define ALLOC_SCOPE(var) AllocStats::Scope var
+#define ALLOC_RECORD(region, var) AllocStats::Record(AllocStats::Region::region, var.Get())
+
+/**
+ *  \brief Adds the allocations made since the previous generation to the generations' aggregate.
+ */
+#define ALLOC_RECORD_GENERATION() AllocStats::RecordGeneration()
+
+/**
+ *  \brief Starts an allocation budget (into a named variable), and checks it, raising a runtime exception if exceeded.
+ */
+#define ALLOC_BUDGET(var, region, maxAllocCnt) AllocStats::Budget var(region, maxAllocCnt)
+#define ALLOC_BUDGET_CHECK(var) var.Check()
+
+#else
+
+#define ALLOC_SCOPE(var)
+#define ALLOC_RECORD(region, var)
+#define ALLOC_RECORD_GENERATION()
+#define ALLOC_BUDGET(var, region, maxAllocCnt)
+#define ALLOC_BUDGET_CHECK(var)
+
+#endif
+
+#endif
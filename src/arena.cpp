@@ -0,0 +1,79 @@
+#include "arena.h"
+#include <cmath>
+#include <algorithm>
+
+Arena::Arena(const unsigned int snakeCnt, const unsigned int gridSideLen, const bool sharedFood,
+             std::shared_ptr<GenAlg> genalg, EventLog *eventLog)
+  : world(gridSideLen, (sharedFood)? 1 : std::max(snakeCnt, (unsigned int) 1)),
+    genalg(genalg),
+    eventLog(eventLog),
+    sharedFood(sharedFood) {
+  // Spread the snakes starting positions evenly over the world grid, in rows and columns.
+  const unsigned int cnt = std::max(snakeCnt, (unsigned int) 1);
+  const unsigned int cols = (unsigned int) std::ceil(std::sqrt((float) cnt));
+  const unsigned int rows = (cnt + cols - 1) / cols;
+  for (unsigned int i = 0; i < cnt; i++) {
+    SDL_Point start{(int) (((i % cols) + 1) * gridSideLen / (cols + 1)), (int) (((i / cols) + 1) * gridSideLen / (rows + 1))};
+    snakes.push_back(std::make_unique<Snake>(start, world, genalg));
+    snakes.back()->SetAutoMode(true);
+    snakes.back()->SetFoodIndex((sharedFood)? 0 : i);
+  }
+}
+
+void Arena::NewBatch() {
+  // Reinitialize the shared world.
+  world.Init();
+
+  // Take the next individuals pending evaluation, one per snake.
+  batchSize = std::min((unsigned int) snakes.size(), genalg->GetPendingCnt());
+  for (unsigned int i = 0; i < batchSize; i++) {
+    snakes[i]->Init();
+    snakes[i]->SetIndividual(genalg->GetPendingIndividual(i));
+  }
+
+  // In case a food was initialized under a snake's starting position, grow it somewhere else.
+  for (unsigned int i = 0; i < world.GetFoodCount(); i++) {
+    if (world.GetElement(world.GetFoodPosition(i)) != World::Element::Food) world.GrowFood(i);
+  }
+}
+
+void Arena::Update() {
+  bool anyAlive = false;
+  for (unsigned int i = 0; i < batchSize; i++) {
+    if (!snakes[i]->IsAlive()) continue;
+
+    snakes[i]->Update();
+
+    // Dead snakes are removed from the shared world, so they don't obstruct the remaining ones.
+    if (snakes[i]->IsAlive()) anyAlive = true;
+    else snakes[i]->RemoveFromWorld();
+  }
+
+  // If any food couldn't be placed after being eaten, the world has no room left and the batch is over.
+  bool worldFull = false;
+  for (unsigned int i = 0; i < world.GetFoodCount(); i++) {
+    if (!world.HasFood(i)) worldFull = true;
+  }
+
+  if (!anyAlive || worldFull) {
+    GradeBatch();
+    NewBatch();
+  }
+}
+
+unsigned int Arena::GetBestScore() const {
+  int bestSize = 1;
+  for (unsigned int i = 0; i < batchSize; i++) bestSize = std::max(bestSize, snakes[i]->GetSize());
+  return (unsigned int) (bestSize - 1);
+}
+
+void Arena::GradeBatch() {
+  // Set each individual fitness as equal to its snake size, as done for single snake rounds.
+  // Obs.: the genetic algorithm's current individual is always the first one of the batch.
+  for (unsigned int i = 0; i < batchSize; i++) {
+    if (eventLog != nullptr) {
+      eventLog->LogGame(EventLog::Source::Arena, *snakes[i], genalg->GetGenerationCnt(), genalg->GetIndividualCnt());
+    }
+    genalg->GradeCurFitness((float) snakes[i]->GetSize());
+  }
+}
@@ -0,0 +1,106 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <vector>
+#include <memory>
+
+#include "world.h"
+#include "snake.h"
+#include "genalg.h"
+#include "eventlog.h"
+
+/**
+ *  \brief Class managing a world shared by several AI snakes, used to evaluate a batch of individuals from the same genetic
+ * algorithm generation at once. Each snake collides with the walls and with every snake's body, and the fitness of each
+ * individual is graded from its own snake's performance.
+ */
+class Arena {
+ public:
+  /**
+   *  \brief Constructor of the Arena class object.
+   *  \param snakeCnt Maximum number of snakes (i.e. individuals) evaluated at once.
+   *  \param gridSideLen The square shared world's width/height, in number of grid cells.
+   *  \param sharedFood Indicates if all snakes compete for a single food (true), or if each one has its own food (false).
+   *  \param genalg The genetic algorithm whose individuals are evaluated.
+   *  \param eventLog Log of the finished games (or nullptr, for no logging).
+   */
+  Arena(const unsigned int snakeCnt, const unsigned int gridSideLen, const bool sharedFood, std::shared_ptr<GenAlg> genalg,
+        EventLog *eventLog = nullptr);
+
+  /**
+   *  \brief Re-initializes the shared world and starts the evaluation of a new batch, made of the next individuals pending
+   * evaluation in the genetic algorithm.
+   */
+  void NewBatch();
+
+  /**
+   *  \brief Updates all snakes of the batch that are still alive. Once all of them are dead (or the world has no room left
+   * for new food), grades the fitness of the batch individuals and starts a new batch.
+   */
+  void Update();
+
+  /**
+   *  \brief Returns the shared world, e.g. for rendering.
+   *  \return Const reference to the shared world.
+   */
+  const World& GetWorld() const { return world; }
+  World& GetWorld() { return world; }
+
+  /**
+   *  \brief Returns the number of snakes in the current batch.
+   *  \return Number of snakes (i.e. individuals) being evaluated.
+   */
+  unsigned int GetBatchSize() const { return batchSize; }
+
+  /**
+   *  \brief Returns one of the snakes in the current batch, e.g. for rendering.
+   *  \param idx Index of the snake, smaller than the batch size.
+   *  \return Const reference to the snake.
+   */
+  const Snake& GetSnake(const unsigned int idx) const { return *snakes[idx]; }
+
+  /**
+   *  \brief Returns the highest score achieved among the snakes of the current batch.
+   *  \return The highest score, in points.
+   */
+  unsigned int GetBestScore() const;
+
+ private:
+  /**
+   *  \brief Grades the fitness of each individual in the current batch, in the same order they were taken from the genetic
+   * algorithm.
+   */
+  void GradeBatch();
+
+  /**
+   *  \brief The world shared by all snakes.
+   */
+  World world;
+
+  /**
+   *  \brief The genetic algorithm whose individuals are evaluated.
+   */
+  std::shared_ptr<GenAlg> genalg;
+
+  /**
+   *  \brief Log of the finished games (or nullptr, for no logging).
+   */
+  EventLog *eventLog;
+
+  /**
+   *  \brief The snakes, each one evaluating an individual of the current batch.
+   */
+  std::vector<std::unique_ptr<Snake>> snakes;
+
+  /**
+   *  \brief Number of individuals in the current batch (may be smaller than the number of snakes at the end of a generation).
+   */
+  unsigned int batchSize{0};
+
+  /**
+   *  \brief Indicates if all snakes compete for a single food, or if each one has its own food.
+   */
+  const bool sharedFood;
+};
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef BITMAPFONT_H
+#define BITMAPFONT_H
+
+#include <cstdint>
+
+/**
+ *  \brief Width of a bitmap font glyph, in font pixels.
+ */
+constexpr int GLYPH_WIDTH = 5;
+
+/**
+ *  \brief Height of a bitmap font glyph, in font pixels.
+ */
+constexpr int GLYPH_HEIGHT = 7;
+
+/**
+ *  \brief Returns the bitmap of a character glyph, from the built-in 5x7 pixels font (used to draw text in the game
+ * window, with no dependency on a font rendering library). Lowercase letters are drawn as uppercase ones, and
+ * characters with no glyph are drawn as a question mark.
+ *  \param c The character.
+ *  \return Array of GLYPH_HEIGHT rows, from top to bottom, where the GLYPH_WIDTH least significant bits of each row are
+ * its pixels, from the leftmost (most significant bit) to the rightmost one.
+ */
+const uint8_t* GetGlyph(const char c);
+
+#endif
@@ -5,14 +5,29 @@
  */
 
 /**
- *  \brief Standard target game frame rate, in frames per second.
+ *  \brief Standard target game frame rate, in frames per second. Frames are rendered at the display refresh rate instead,
+ * whenever it's known.
  */
 #define FRAME_RATE_FPS 60
 
 /**
- *  \brief Standard target game frame period, in milliseconds.
+ *  \brief Target game simulation rate (unless in speed mode), in steps per second.
+ * Frames rendered between simulation steps interpolate the snakes' head and tail motion, so this may be lower than the 
+ * frame rate without making the motion choppy.
  */
-#define FRAME_PERIOD_MS (1000 / FRAME_RATE_FPS) 
+#define SIM_STEP_RATE 24
+
+/**
+ *  \brief Time margin before a frame deadline within which the waiting thread spins instead of sleeping, in microseconds.
+ * Shall cover the typical delay of the OS scheduler in waking up a sleeping thread.
+ */
+#define FRAME_SPIN_MARGIN_US 2000
+
+/**
+ *  \brief Maximum number of simulation steps run at once to catch up with the elapsed time, e.g. after the simulation was
+ * stalled. Any further elapsed time is dropped, so the game doesn't fast-forward.
+ */
+#define SIM_MAX_CATCHUP_STEPS 5
 
 /**
  *  \brief The width of the game screen window, in screen coordinates.
@@ -24,16 +39,145 @@
  */
 #define WINDOW_HEIGHT WINDOW_WIDTH
 
+/**
+ *  \brief Selects the grid rendering backend: a streaming texture with one pixel per grid cell, uploaded and scaled to the
+ * window once per frame (true), or a window-sized target texture where each changed tile is painted as a filled
+ * rectangle (false). The former keeps up with large grids, also with the SDL software renderer.
+ */
+#define RENDER_STREAMING_TEXTURE true
+
+/**
+ *  \brief Number of frame buffers queued for the background encoder while capturing the rendered frames to a video. Once
+ * all of them are queued, rendering waits for the encoder, so no frame is dropped.
+ */
+#define FRAME_CAPTURE_BUFFERS 8
+
+/**
+ *  \brief Time an in-window notification stays shown (unless dismissed earlier by a key press), in milliseconds.
+ */
+#define OVERLAY_NOTIFICATION_MS 2500
+
+/**
+ *  \brief Size of each in-window overlay text font pixel, in screen pixels (reduced for narrow windows).
+ */
+#define OVERLAY_TEXT_SCALE 2
+
+/**
+ *  \brief Maximum time the main thread sleeps waiting for user input while the game is idle (i.e. paused, waiting for the
+ * player's answer, or with its window hidden), in milliseconds.
+ */
+#define IDLE_WAIT_TIMEOUT_MS 250
+
+/**
+ *  \brief Indicates if the AI runs in speed mode (i.e. with no simulation rate control) while the game window is hidden 
+ * (minimized), as nothing is rendered then anyway.
+ */
+#define HIDDEN_WINDOW_SPEED_MODE true
+
 /**
  *  \brief The side length of the square game grid, in game coordinates units.
  */
 #define GRID_SIDE_LENGTH 31
 
+/**
+ *  \brief Minimum and maximum side lengths of the square game grid accepted as a command line argument, in game coordinates
+ * units. The window keeps (roughly) the standard size, and its grid cells shrink down to one pixel for large grids.
+ */
+#define GRID_MIN_SIDE_LENGTH 5
+#define GRID_MAX_SIDE_LENGTH 1024
+
+/**
+ *  \brief Maximum number of user commands received but not processed yet.
+ */
+#define CONTROLLER_QUEUE_LEN 64
+
+/**
+ *  \brief Maximum number of player turns queued for the snake to take, one per grid tile crossing.
+ */
+#define SNAKE_TURN_QUEUE_LEN 8
+
+/**
+ *  \brief Number of integer sub-tile motion ticks the snake's head needs to cross one grid tile.
+ * At one tick per simulation step, this results in a snake speed of SIM_STEP_RATE/SNAKE_TICKS_PER_TILE tiles per second.
+ */
+#define SNAKE_TICKS_PER_TILE 2
+
+/**
+ *  \brief Number of AI snakes (i.e. individuals from the same generation) simultaneously evaluated in arena mode, where
+ * they share one larger world grid.
+ */
+#define ARENA_SNAKES_CNT 16
+
+/**
+ *  \brief The side length of the square world grid shared by the snakes in arena mode, in game coordinates units.
+ */
+#define ARENA_GRID_SIDE_LENGTH 63
+
+/**
+ *  \brief Indicates if the snakes in arena mode compete for a single shared food (true), or if each one has its own food
+ * (false). In the latter case, a snake can still eat other snakes' foods.
+ */
+#define ARENA_SHARED_FOOD false
+
+/**
+ *  \brief Number of AI games (i.e. individuals from the same generation) simultaneously played in mosaic mode, where each
+ * one has its own world, and all of them are shown side by side (up to 256 games keep the frame rate).
+ */
+#define MOSAIC_GAMES_CNT 64
+
+/**
+ *  \brief The side length of each game's square world grid in mosaic mode, in game coordinates units.
+ */
+#define MOSAIC_GRID_SIDE_LENGTH 16
+
+/**
+ *  \brief Indicates if the AI keeps on training in background worker threads (with no rendering) while the player controls
+ * the snake in manual mode.
+ */
+#define BACKGROUND_TRAINING true
+
+/**
+ *  \brief Number of background training worker threads, or 0 to use the hardware threads left by the game's main and
+ * simulation threads (at least one).
+ */
+#define BACKGROUND_TRAINING_WORKERS 0
+
+/**
+ *  \brief Fraction of the time (between 0 and 1, exclusive of 0) each background training worker spends working, in time
+ * slices of BACKGROUND_TRAINING_SLICE_US, sleeping for the rest. Keeps the CPU available for the game's frame budget.
+ */
+#define BACKGROUND_TRAINING_DUTY_CYCLE 0.5
+
+/**
+ *  \brief Length of the background training workers' working time slices, in microseconds.
+ */
+#define BACKGROUND_TRAINING_SLICE_US 2000
+
 /**
  *  \brief The path and name of the file used to store the game history information and genetic algorithm state.
  */
 #define SAVE_STATE_FILE_PATH "../save_state.txt"
 
+/**
+ *  \brief Indicates if each new record game round (of the player or of the AI, in single snake rounds) is stored as a replay
+ * file, whose path is REPLAY_FILE_PATH_PREFIX followed by "player" or "ai", the score and the ".replay" extension.
+ */
+#define REPLAY_RECORDS true
+#define REPLAY_FILE_PATH_PREFIX "../record_"
+
+/**
+ *  \brief Number of snake actions (i.e. grid tiles) between consecutive keyframes in a replay. Lower values make seeking
+ * faster, and the replay files larger.
+ */
+#define REPLAY_KEYFRAME_INTERVAL 256
+
+/**
+ *  \brief Minimum number of finished game records the event log can hold while waiting to be written (more records are
+ * dropped), and interval between its writes to the file, in milliseconds.
+ */
+#define EVENT_LOG_CAPACITY 65536
+#define EVENT_LOG_FLUSH_MS 20
+
 /**
  *  Snake's AI MLP (Multi-layer Perceptron) and GA (Genetic Algorithm) parameters
  */
@@ -59,4 +203,30 @@
  */
 #define GA_MUTATION_RATE 0.02
 
+/**
+ *  Snake's AI lookahead search parameters
+ */
+
+/**
+ *  \brief Maximum depth, in grid tiles, of the snake's AI lookahead search tree.
+ */
+#define SNAKE_SEARCH_MAX_DEPTH 8
+
+/**
+ *  \brief Score added to a lookahead search branch for each food eaten along it. Shall be greater than the MLP output
+ * range ([0;1]), so that eating always outweighs the MLP heuristic score of the branch leaf.
+ */
+#define SNAKE_SEARCH_FOOD_REWARD 10.0f
+
+/**
+ *  \brief Maximum number of tree nodes expanded by the lookahead search per decision, while the frame rate is controlled.
+ */
+#define SNAKE_SEARCH_NODE_BUDGET 20000
+
+/**
+ *  \brief Maximum time spent by the lookahead search per decision while the frame rate is controlled, in microseconds.
+ * Kept well below the frame period, so the game stays within its 60 fps frame budget.
+ */
+#define SNAKE_SEARCH_TIME_BUDGET_US 4000
+
 #endif
\ No newline at end of file
@@ -1,56 +1,120 @@
 #include "controller.h"
 #include "SDL.h"
+#include "config.h"
 
-Controller::UserCommand Controller::ReceiveCommand() {
-  UserCommand command{UserCommand::None};
+Controller::Controller() : commands(CONTROLLER_QUEUE_LEN) {}
+
+void Controller::ReceiveCommands() {
+  SDL_Event e;
+  while (SDL_PollEvent(&e)) QueueCommand(e);
+}
 
+void Controller::WaitCommands(const Uint32 timeoutMs) {
+  // Block until an event arrives (or the timeout expires), then take any other pending events as well.
   SDL_Event e;
-  while (SDL_PollEvent(&e)) {
-    if (e.type == SDL_QUIT) {
-      // If latest command consisted of closing the game window, return the Quit command.
-      command = UserCommand::Quit;
-    } else if (e.type == SDL_KEYDOWN) {
-      // Otherwise, if a key has been pressed, identify which key it was and return the appropriate command.
-      switch (e.key.keysym.sym) {
-        case SDLK_UP:
-          command = UserCommand::GoUp;
-          break;
-
-        case SDLK_DOWN:
-          command = UserCommand::GoDown;
-          break;
-
-        case SDLK_LEFT:
-          command = UserCommand::GoLeft;
-          break;
-
-        case SDLK_RIGHT:
-          command = UserCommand::GoRight;
-          break;
-
-        case SDLK_a:
-          command = UserCommand::ToggleAutoMode;
-          break;
-
-        case SDLK_s:
-          command = UserCommand::ToggleFpsCtrl;
-          break;
-
-        case SDLK_p:
-          command = UserCommand::Pause;
-          break;
-
-        case SDLK_e:
-          command = UserCommand::EraseData;
-          break;
-
-        default:
-          // No valid command
-          command = UserCommand::None;
-          break;
-      }
+  if (SDL_WaitEventTimeout(&e, (int) timeoutMs)) {
+    QueueCommand(e);
+    ReceiveCommands();
+  }
+}
+
+void Controller::QueueCommand(const SDL_Event& e) {
+  UserCommand command{UserCommand::None};
+
+  if (e.type == SDL_QUIT) {
+    // If the command consisted of closing the game window, queue the Quit command.
+    command = UserCommand::Quit;
+  } else if (e.type == SDL_WINDOWEVENT) {
+    // If the window contents were lost or shown again, queue a Redraw command.
+    if (e.window.event == SDL_WINDOWEVENT_EXPOSED || e.window.event == SDL_WINDOWEVENT_SHOWN 
+        || e.window.event == SDL_WINDOWEVENT_RESTORED) {
+      command = UserCommand::Redraw;
+    }
+  } else if (e.type == SDL_KEYDOWN) {
+    // Otherwise, if a key has been pressed, identify which key it was and queue the appropriate command.
+    switch (e.key.keysym.sym) {
+      case SDLK_UP:
+        command = UserCommand::GoUp;
+        break;
+
+      case SDLK_DOWN:
+        command = UserCommand::GoDown;
+        break;
+
+      case SDLK_LEFT:
+        command = UserCommand::GoLeft;
+        break;
+
+      case SDLK_RIGHT:
+        command = UserCommand::GoRight;
+        break;
+
+      case SDLK_a:
+        command = UserCommand::ToggleAutoMode;
+        break;
+
+      case SDLK_s:
+        command = UserCommand::ToggleFpsCtrl;
+        break;
+
+      case SDLK_p:
+        command = UserCommand::Pause;
+        break;
+
+      case SDLK_e:
+        command = UserCommand::EraseData;
+        break;
+
+      case SDLK_l:
+        command = UserCommand::ToggleLookahead;
+        break;
+
+      case SDLK_m:
+        command = UserCommand::ToggleArenaMode;
+        break;
+
+      case SDLK_c:
+        command = UserCommand::ToggleShowcase;
+        break;
+
+      case SDLK_g:
+        command = UserCommand::ToggleMosaicMode;
+        break;
+
+      case SDLK_i:
+        command = UserCommand::DumpStats;
+        break;
+
+      case SDLK_y:
+        command = UserCommand::AnswerYes;
+        break;
+
+      case SDLK_n:
+        command = UserCommand::AnswerNo;
+        break;
+
+      case SDLK_RETURN:
+      case SDLK_ESCAPE:
+        command = UserCommand::AnswerDefault;
+        break;
+
+      default:
+        // No game command, but still a key press.
+        command = UserCommand::OtherKey;
+        break;
     }
   }
 
-  return command;
+  // Queue any valid command, dropping the oldest one if the queue is full.
+  if (command != UserCommand::None) {
+    if (commands.Size() == commands.Capacity()) commands.PopFront();
+    commands.PushBack(TimedCommand{command, e.common.timestamp});
+  }
+}
+
+bool Controller::PopCommand(TimedCommand& command) {
+  if (commands.Empty()) return false;
+  command = commands.Front();
+  commands.PopFront();
+  return true;
 }
\ No newline at end of file
@@ -1,8 +1,11 @@
 #ifndef CONTROLLER_H
 #define CONTROLLER_H
 
+#include "SDL.h"
+#include "ringbuffer.h"
+
 /**
- *  \brief Class responsible for processing the user inputs and returning any valid commands.
+ *  \brief Class responsible for processing the user inputs and queueing any valid commands, in the order they were issued.
  */
 class Controller {
  public:
@@ -17,16 +20,74 @@ class Controller {
    * - ToggleFpsCtrl: "s" key (toggles the frame rate control on and off);
    * - Pause/resume game: "p" key;
    * - Erase/reset game history and AI learning: "e" key;
+   * - ToggleLookahead: "l" key (toggles the AI lookahead search on and off);
+   * - ToggleArenaMode: "m" key (toggles the multi-snake arena mode on and off);
+   * - ToggleShowcase: "c" key (toggles the champion showcase mode on and off);
+   * - ToggleMosaicMode: "g" key (toggles the mosaic mode, i.e. a grid of AI games, on and off);
+   * - AnswerYes: "y" key (answers 'Yes' to an in-window confirmation);
+   * - AnswerNo: "n" key (answers 'No' to an in-window confirmation);
+   * - AnswerDefault: Enter or Escape keys (selects the default option of an in-window confirmation);
+   * - Redraw: the game window was exposed or shown again, and its contents shall be redrawn;
+   * - OtherKey: any other key (only dismisses in-window notifications);
    * - None: default value (i.e. no valid command has been issued).
    */
   enum class UserCommand { None, Quit, GoUp, GoRight, GoDown, GoLeft, 
-    ToggleAutoMode, ToggleFpsCtrl, Pause, EraseData };
+    ToggleAutoMode, ToggleFpsCtrl, Pause, EraseData, ToggleLookahead, ToggleArenaMode, ToggleShowcase, 
+    ToggleMosaicMode, DumpStats, AnswerYes, AnswerNo, AnswerDefault, Redraw, OtherKey };
+
+  /**
+   *  \brief A user command, along with the time it was issued.
+   */
+  struct TimedCommand {
+    /**
+     *  \brief The user command.
+     */
+    UserCommand command;
+
+    /**
+     *  \brief The time the command was issued (i.e. the input event time), in milliseconds since SDL initialization.
+     */
+    Uint32 timestamp;
+  };
+
+  /**
+   *  \brief Constructor of the Controller class object. The command queue is allocated here.
+   */
+  Controller();
+
+  /**
+   *  \brief Processes all pending user input events, queueing a timestamped command for each valid one (so that several 
+   * inputs issued within the same frame, e.g. quick double-taps, are all kept).
+   * If the queue is full, the oldest command is dropped.
+   */
+  void ReceiveCommands();
+
+  /**
+   *  \brief Waits for a user input event (sleeping, instead of polling), then processes all pending events as 
+   * ReceiveCommands does. Used while the game is idle, so that it doesn't keep a CPU core busy.
+   *  \param timeoutMs Maximum waiting time, in milliseconds.
+   */
+  void WaitCommands(const Uint32 timeoutMs);
+
+  /**
+   *  \brief Takes the oldest queued command, if any.
+   *  \param command Output parameter set with the oldest queued command.
+   *  \return True, if a command was taken; false, if the queue is empty.
+   */
+  bool PopCommand(TimedCommand& command);
+
+ private:
+  /**
+   *  \brief Identifies the command issued by an input event, and queues it (in case it's a valid one). If the queue is 
+   * full, the oldest command is dropped.
+   *  \param e The input event.
+   */
+  void QueueCommand(const SDL_Event& e);
 
   /**
-   *  \brief Process the user input and returns the latest command issued to the game.
-   *  \return The latest player command.
+   *  \brief Bounded queue of the received commands not processed yet, from the oldest to the latest one.
    */
-  UserCommand ReceiveCommand();  
+  RingBuffer<TimedCommand> commands;
 };
 
 #endif
\ No newline at end of file
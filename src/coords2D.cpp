@@ -1,5 +1,4 @@
 #include "coords2D.h"
-#include <cmath>
 #include <climits>
 #include <stdexcept>
 #include "clip.h"
@@ -13,95 +12,6 @@ unsigned long int GetManhattanDistance(const SDL_Point& a, const SDL_Point& b) {
     return (unsigned long int) CLPD_INT_ABSDIFF(a.x, b.x) + (unsigned long int) CLPD_INT_ABSDIFF(a.y, b.y);
 }
 
-Coords2D::Coords2D() : SDL_Point{0,0}, FPoint{0.0,0.0} {}
-
-Coords2D::Coords2D(const int x, const int y) : 
-    SDL_Point{x, y}, 
-    FPoint{(float) x, (float) y} {}
-
-Coords2D::Coords2D(const float& x, const float& y) :  
-    FPoint{CLPD_FLT_INTLIMS(x), CLPD_FLT_INTLIMS(y)} {
-    this->SDL_Point::x = (int) this->FPoint::x;
-    this->SDL_Point::y = (int) this->FPoint::y;
-}
-
-Coords2D::Coords2D(const SDL_Point& sdlPoint) :
-    SDL_Point{sdlPoint}, 
-    FPoint{(float) sdlPoint.x, (float) sdlPoint.y} {}
-
-Coords2D::Coords2D(const FPoint& sdlPoint) :
-    FPoint{CLPD_FLT_INTLIMS(sdlPoint.x), CLPD_FLT_INTLIMS(sdlPoint.y)} {
-    this->SDL_Point::x = (int) this->FPoint::x;
-    this->SDL_Point::y = (int) this->FPoint::y;
-}
-    
-
-Coords2D& Coords2D::operator=(const SDL_Point& sdlPoint) {
-    this->SDL_Point::x = sdlPoint.x;
-    this->SDL_Point::y = sdlPoint.y;
-    this->FPoint::x = (float) sdlPoint.x;
-    this->FPoint::y = (float) sdlPoint.y;
-    return *this;
-}
-
-Coords2D& Coords2D::operator=(const FPoint& sdlPoint) {
-    this->FPoint::x = CLPD_FLT_INTLIMS(sdlPoint.x);
-    this->FPoint::y = CLPD_FLT_INTLIMS(sdlPoint.y);
-    this->SDL_Point::x = (int) this->FPoint::x;
-    this->SDL_Point::y = (int) this->FPoint::y;
-    return *this;
-}
-
-bool Coords2D::operator==(const SDL_Point& point) {
-    return (this->SDL_Point::x == point.x) && (this->SDL_Point::y == point.y);
-}
-
-template<typename T>
-Coords2D Coords2D::operator+(const T& sdlDelta) const {
-    Coords2D displacedCoords;
-    // Displace the continuous/float coordinates first.
-    displacedCoords.FPoint::x = CLPD_FLT_SUM(this->FPoint::x, (float) sdlDelta.x);
-    displacedCoords.FPoint::y = CLPD_FLT_SUM(this->FPoint::y, (float) sdlDelta.y);
-    // Guarantee the continuous/float coordinates are inside integer range, by clipping them at int limits.
-    displacedCoords.FPoint::x = CLPD_FLT_INTLIMS(displacedCoords.FPoint::x);
-    displacedCoords.FPoint::y = CLPD_FLT_INTLIMS(displacedCoords.FPoint::y);
-    // Set the int coordinates using the clipped float coordinates. 
-    displacedCoords.SDL_Point::x = (int) displacedCoords.FPoint::x;
-    displacedCoords.SDL_Point::y = (int) displacedCoords.FPoint::y;
-    return displacedCoords;
-}
-
-template<typename T>
-Coords2D& Coords2D::operator+=(const T& sdlDelta) {
-    // Displace the continuous/float coordinates first.
-    this->FPoint::x = CLPD_FLT_SUM(this->FPoint::x, (float) sdlDelta.x);
-    this->FPoint::y = CLPD_FLT_SUM(this->FPoint::y, (float) sdlDelta.y);
-    // Guarantee the continuous/float coordinates are inside integer range, by clipping them at int limits.
-    this->FPoint::x = CLPD_FLT_INTLIMS(this->FPoint::x);
-    this->FPoint::y = CLPD_FLT_INTLIMS(this->FPoint::y);
-    // Set the int coordinates using the clipped float coordinates.
-    this->SDL_Point::x = (int) this->FPoint::x;
-    this->SDL_Point::y = (int) this->FPoint::y;
-    return *this;
-}
-
-float Coords2D::GetEuclideanDistanceTo(const FPoint& reference) const {
-    // As the coordinates are controlled to be inside integer limits, there's no risk of data loss in returning a float number. 
-    // (Considering the "pow" and "sqrt" operations return double-precision values)
-    return sqrt(pow(this->FPoint::x - reference.x, 2) + pow(this->FPoint::y - reference.y, 2));
-}
-
-unsigned long int Coords2D::GetManhattanDistanceTo(const SDL_Point& reference) const {
-    return (unsigned long int) CLPD_INT_ABSDIFF(this->SDL_Point::x, reference.x) 
-            + (unsigned long int) CLPD_INT_ABSDIFF(this->SDL_Point::y, reference.y);
-}
-
-// Explicit instantiation of all valid templates for Coords2D sum operators.
-template Coords2D Coords2D::operator+(const SDL_Point& sdlDelta) const;
-template Coords2D Coords2D::operator+(const FPoint& sdlDelta) const;
-template Coords2D& Coords2D::operator+=(const SDL_Point& sdlDelta);
-template Coords2D& Coords2D::operator+=(const FPoint& sdlDelta);
-
 Direction2D GetLeftOf(const Direction2D reference) {
   return static_cast<Direction2D>((static_cast<uint8_t>(reference) + 3) % 4); 
 }
@@ -170,4 +80,18 @@ SDL_Point GetVersor(const SDL_Point& origin, const SDL_Point& dest, const Direct
   }
   
   return output;
+}
+
+bool AdvanceCoords(Coords2D& coords, const Direction2D direction, const unsigned int ticks, const unsigned int ticksPerTile) {
+  // Accumulate the sub-tile progress and check if it is enough to cross into the next tile.
+  unsigned int progress = coords.ticks + ticks;
+  if (progress < ticksPerTile) {
+    coords.ticks = (uint16_t) progress;
+    return false;
+  }
+
+  // Move to the adjacent tile and carry over the remaining progress.
+  coords.tile = GetAdjPosition(coords.tile, direction);
+  coords.ticks = (uint16_t) (progress - ticksPerTile);
+  return true;
 }
\ No newline at end of file
@@ -1,16 +1,9 @@
 #ifndef COORDS2D_H
 #define COORDS2D_H
 
-#include "SDL.h"
+#include <cstdint>
 
-/**
- *  \brief 2D point with floating-point-type coordinates. 
- */
-typedef struct FPoint
-{
-  float x;
-  float y;
-} FPoint;
+#include "SDL.h"
 
 /**
  *  \brief "Equal" condition operator for the SDL_Point struct defined in SDL2 library.
@@ -28,116 +21,6 @@ bool operator==(const SDL_Point& a, const SDL_Point& b);
  */
 unsigned long int GetManhattanDistance(const SDL_Point& a, const SDL_Point& b);
 
-/**
- *  \brief Class representing a point in a 2D space, encapsulating both its discrete and continuous coordinates, and 
- * guaranteeing they are coherent and inside valid data range.
- * Inherits from both SDL_Point (discrete) and FPoint (continuous) structs.
- */
-class Coords2D : public SDL_Point, public FPoint {
- public:
-  /**
-   *  \brief Default constructor (origin at zero).
-   */
-  Coords2D();
-
-  /**
-   *  \brief Constructor using int inputs.
-   *  \param x X-axis coordinate.
-   *  \param y Y-axis coordinate.
-   */
-  Coords2D(const int x, const int y);
-
-  /**
-   *  \brief Constructor using float inputs.
-   *  \param x X-axis coordinate.
-   *  \param y Y-axis coordinate.
-   */
-  Coords2D(const float& x, const float& y);
-
-  /**
-   *  \brief Constructor using SDL2 SDL_Point (int) discrete coordinates.
-   *  \param sdlPoint SDL2 discrete coordinates to be copied for Coords2D initialization.
-   */
-  Coords2D(const SDL_Point& sdlPoint);
-
-  /**
-   *  \brief Constructor using FPoint (float) continuous coordinates.
-   *  \param sdlPoint SDL2 continuous coordinates to be copied for Coords2D initialization.
-   */
-  Coords2D(const FPoint& sdlPoint);
-
-  /**
-   *  \brief Assignment operator for usage with SDL_Point type.
-   *  \param sdlPoint Point representing the discrete coordinates to be assigned.
-   */
-  Coords2D& operator=(const SDL_Point& sdlPoint);
-
-  /**
-   *  \brief Assignment operator for usage with FPoint type.
-   *  \param sdlPoint Point representing the continuous coordinates to be assigned.
-   */
-  Coords2D& operator=(const FPoint& sdlPoint);
-
-  /**
-   *  \brief Comparison operator for usage with SDL2 struct types (i.e. SDL_Point or FPoint).
-   *  \param point SDL discrete point representing the coordinates to be compared to.
-   *  \return Boolean indicating true if object's discrete position is equal to argument; or false otherwise.
-   */
-  bool operator==(const SDL_Point& point);
- 
-  /**
-   *  \brief Sum operator for usage with SDL2 struct types (i.e. SDL_Point or FPoint).
-   *  \param sdlDelta Struct representing the displacement to be summed with the Coords2D object.
-   *  \return New Coords2D object pointing to the displaced coordinates.
-   */
-  template<typename T> Coords2D operator+(const T& sdlDelta) const;
-
-  /**
-   *  \brief Sum and assignment operator for usage with SDL2 struct types (i.e. SDL_Point or FPoint).
-   *  \param sdlDelta Struct representing the displacement to be summed with the Coords2D object.
-   *  \return Reference to the same Coords2D object, now with displaced coordinates.
-   */
-  template<typename T> Coords2D& operator+=(const T& sdlDelta);
-
-  /**
-   *  \brief Calculates and returns the Euclidean distance between the object and a SDL2 continuous coordinate.
-   *  \param reference Struct representing the coordinates for which to calculate the distance to.
-   *  \return The Euclidean distance.
-   */
-  float GetEuclideanDistanceTo(const FPoint& reference) const;
-
-  /**
-   *  \brief Calculates and returns the Manhattan distance between the object and a SDL2 discrete coordinate.
-   *  \param reference Struct representing the coordinates for which to calculate the distance to.
-   *  \return The Manhattan distance, in unsigned long integer format (to prevent data loss, due to int range of inputs).
-   */
-  unsigned long int GetManhattanDistanceTo(const SDL_Point& reference) const;
-
-  /**
-   *  \brief Inline accessor for the discrete X-axis coordinate.
-   *  \return Integer value.
-   */
-  inline int GetIntX() const { return this->SDL_Point::x; }
-
-  /**
-   *  \brief Inline accessor for the discrete Y-axis coordinate.
-   *  \return Integer value.
-   */
-  inline int GetIntY() const { return this->SDL_Point::y; }
-
-  /**
-   *  \brief Inline accessor for the continuous X-axis coordinate.
-   *  \return Float value.
-   */
-  inline float GetRealX() const { return this->FPoint::x; }
-
-  /**
-   *  \brief Inline accessor for the continuous Y-axis coordinate.
-   *  \return Float value.
-   */
-  inline float GetRealY() const { return this->FPoint::y; }
-};
-
 /**
  *  \brief Global 2D direction enum. Values are clockwise ordered.
  */
@@ -184,4 +67,32 @@ SDL_Point GetAdjPosition(const SDL_Point& position, const Direction2D direction)
  */
 SDL_Point GetVersor(const SDL_Point& origin, const SDL_Point& dest, const Direction2D refDir);
 
+/**
+ *  \brief Plain-old-data 2D position with integer fixed-point sub-tile precision: a discrete grid tile plus the number of
+ * motion ticks already advanced from it towards the next tile. As no floating-point representation is involved, motion is
+ * exact and never drifts, and the struct can be freely copied or stored in contiguous arrays.
+ */
+struct Coords2D {
+  /**
+   *  \brief The discrete grid tile coordinates.
+   */
+  SDL_Point tile;
+
+  /**
+   *  \brief Sub-tile progress, in motion ticks, from the tile towards the adjacent one in the direction of movement.
+   */
+  uint16_t ticks;
+};
+
+/**
+ *  \brief Advances a sub-tile position in the input direction. Whenever the accumulated ticks reach the number of ticks per tile,
+ * the position moves to the adjacent tile and the remaining ticks are carried over.
+ *  \param coords The position to be advanced.
+ *  \param direction The direction of movement.
+ *  \param ticks Number of ticks to advance.
+ *  \param ticksPerTile Number of ticks needed to cross one tile.
+ *  \return True, if the position entered a new tile; false, if it remained in the same one.
+ */
+bool AdvanceCoords(Coords2D& coords, const Direction2D direction, const unsigned int ticks, const unsigned int ticksPerTile);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,66 @@
+#include "eventlog.h"
+#include <stdexcept>
+#include <chrono>
+#include "config.h"
+
+EventLog::EventLog(const std::string& path, const unsigned int capacity) : queue(capacity) {
+  csv = path.size() >= 4 && path.compare(path.size() - 4, 4, ".csv") == 0;
+  file = std::fopen(path.c_str(), "w");
+  if (file == nullptr) throw std::runtime_error("Event log file \"" + path + "\" could not be opened.");
+  if (csv) std::fputs("source,generation,individual,score,steps,tiles_visited,death_cause,wall_time_us\n", file);
+
+  writer = std::thread(&EventLog::Write, this);
+}
+
+EventLog::~EventLog() {
+  stopping = true;
+  writer.join();
+  std::fclose(file);
+}
+
+void EventLog::LogGame(const Source source, const Snake& snake, const unsigned int generation, const unsigned int individual) {
+  // A game ending with the snake alive was won.
+  const Replay::EndCause endCause = (snake.IsAlive())? Replay::EndCause::Victory : Replay::GetEndCause(snake.GetDeathCause());
+  const Record record{source, generation, individual, (unsigned int) (snake.GetSize() - 1), snake.GetStepCnt(),
+                      snake.GetVisitedTileCnt(), endCause, snake.GetLifetimeUs()};
+  if (!queue.Push(record)) droppedCnt++;
+}
+
+void EventLog::Write() {
+  while (true) {
+    // Check for the stop request before draining the queue, so the records queued before it are all written.
+    const bool stop = stopping;
+    Record record;
+    bool written = false;
+    while (queue.Pop(record)) {
+      WriteRecord(record);
+      written = true;
+    }
+    if (written) std::fflush(file);
+    if (stop) return;
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(EVENT_LOG_FLUSH_MS));
+  }
+}
+
+void EventLog::WriteRecord(const Record& record) {
+  if (csv) {
+    std::fprintf(file, "%s,%u,%u,%u,%lu,%u,%s,%lu\n", GetSourceName(record.source), record.generation, record.individual,
+                 record.score, record.steps, record.visitedTiles, Replay::GetEndCauseName(record.endCause),
+                 record.wallTimeUs);
+  } else {
+    std::fprintf(file, "{\"source\":\"%s\",\"generation\":%u,\"individual\":%u,\"score\":%u,\"steps\":%lu,"
+                 "\"tiles_visited\":%u,\"death_cause\":\"%s\",\"wall_time_us\":%lu}\n", GetSourceName(record.source),
+                 record.generation, record.individual, record.score, record.steps, record.visitedTiles,
+                 Replay::GetEndCauseName(record.endCause), record.wallTimeUs);
+  }
+}
+
+const char* EventLog::GetSourceName(const Source source) {
+  switch (source) {
+    case Source::Arena: return "arena";
+    case Source::Mosaic: return "mosaic";
+    case Source::Trainer: return "trainer";
+    default: return "game";
+  }
+}
@@ -0,0 +1,118 @@
+#ifndef EVENTLOG_H
+#define EVENTLOG_H
+
+#include <string>
+#include <cstdio>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+
+#include "snake.h"
+#include "replay.h"
+#include "mpscqueue.h"
+
+/**
+ *  \brief Class logging one record per finished AI game (from the game itself, the arena, the mosaic or the trainer's
+ * workers) to a file, as JSON lines or CSV. Records are pushed to a lock-free queue by the game threads, and written out by
+ * a background thread, so that logging never blocks nor allocates in the game loops. If the queue is full (i.e. the writer
+ * can't keep up), records are dropped and counted instead.
+ */
+class EventLog {
+ public:
+  /**
+   *  \brief Record source enum: the game snake (single snake rounds), the arena, the mosaic, or a background trainer worker.
+   */
+  enum class Source : uint8_t { Game, Arena, Mosaic, Trainer };
+
+  /**
+   *  \brief Record of a finished game.
+   */
+  struct Record {
+    Source source;
+    unsigned int generation;
+    unsigned int individual;
+    unsigned int score;
+    unsigned long steps;
+    unsigned int visitedTiles;
+    Replay::EndCause endCause;
+    unsigned long wallTimeUs;
+  };
+
+  /**
+   *  \brief Constructor of the EventLog class object. Opens the output file and starts the writer thread. If the file can't
+   * be opened, a runtime exception is raised.
+   *  \param path The output file path. Paths ending in ".csv" get CSV records (after a header line), and any other path gets
+   * JSON lines (one JSON object per record).
+   *  \param capacity Minimum number of records queued for writing at once.
+   */
+  EventLog(const std::string& path, const unsigned int capacity);
+
+  /**
+   *  \brief Destructor of the EventLog class object. Writes the queued records, then stops the writer thread and closes the
+   * output file.
+   */
+  ~EventLog();
+
+  /**
+   *  \brief Queues the record of a finished game (from any thread), with no waiting.
+   *  \param source The record source.
+   *  \param snake The game's snake, right after its game ended (i.e. it died or won).
+   *  \param generation The genetic algorithm generation of the snake's individual.
+   *  \param individual Index of the snake's individual in its generation.
+   */
+  void LogGame(const Source source, const Snake& snake, const unsigned int generation, const unsigned int individual);
+
+  /**
+   *  \brief Returns the number of records dropped so far, as the queue was full.
+   *  \return Dropped records count.
+   */
+  unsigned long GetDroppedCnt() const { return droppedCnt; }
+
+ private:
+  /**
+   *  \brief Writer thread routine: writes the queued records out at regular intervals (see EVENT_LOG_FLUSH_MS), until the
+   * log is destroyed and its queue is empty.
+   */
+  void Write();
+
+  /**
+   *  \brief Writes a record to the output file, in the selected format.
+   *  \param record The record.
+   */
+  void WriteRecord(const Record& record);
+
+  /**
+   *  \brief Returns the name of a record source.
+   *  \param source The record source.
+   *  \return Source name, in lowercase.
+   */
+  static const char* GetSourceName(const Source source);
+
+  /**
+   *  \brief The output file, and whether it's written as CSV (or JSON lines, otherwise).
+   */
+  std::FILE *file{nullptr};
+  bool csv{false};
+
+  /**
+   *  \brief Queue of records waiting to be written.
+   */
+  MpscQueue<Record> queue;
+
+  /**
+   *  \brief Number of records dropped, as the queue was full.
+   */
+  std::atomic<unsigned long> droppedCnt{0};
+
+  /**
+   *  \brief Flag indicating if the log is being destroyed.
+   */
+  std::atomic<bool> stopping{false};
+
+  /**
+   *  \brief The writer thread.
+   */
+  std::thread writer;
+};
+
+#endif
@@ -0,0 +1,187 @@
+#include "frameencoder.h"
+#include <stdexcept>
+#include <algorithm>
+
+/**
+ *  \brief Indicates if a string ends with a given suffix.
+ *  \param text The string.
+ *  \param suffix The suffix.
+ *  \return True, if the string ends with the suffix.
+ */
+static bool EndsWith(const std::string& text, const std::string& suffix) {
+  return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+/**
+ *  \brief Indicates if a path is a valid frame file pattern: it shall hold exactly one integer conversion ("%d" or "%i",
+ * optionally with flags and a field width, e.g. "%05d"), and any other '%' character shall be escaped as "%%". A valid
+ * pattern is safe to be used as the format string of a printf-style call with a single int argument.
+ *  \param path The path.
+ *  \return True, if the path is a valid pattern; false, otherwise.
+ */
+static bool IsFramePathPattern(const std::string& path) {
+  unsigned int conversionCnt = 0;
+  for (std::size_t i = 0; i < path.size(); i++) {
+    if (path[i] != '%') continue;
+    if (++i < path.size() && path[i] == '%') continue;
+    while (i < path.size() && std::string("-+ #0").find(path[i]) != std::string::npos) i++;
+    while (i < path.size() && path[i] >= '0' && path[i] <= '9') i++;
+    if (i >= path.size() || (path[i] != 'd' && path[i] != 'i')) return false;
+    conversionCnt++;
+  }
+  return conversionCnt == 1;
+}
+
+FrameEncoder::FrameEncoder(const std::string& path, const unsigned int width, const unsigned int height,
+                           const unsigned int frameRate, const unsigned int bufferCnt)
+  : path(path),
+    width(width),
+    height(height),
+    frameRate(frameRate),
+    buffers(std::max(bufferCnt, (unsigned int) 1), std::vector<Uint8>((std::size_t) width * height * 3)),
+    freeBuffers(buffers.size()),
+    queuedBuffers(buffers.size()) {
+  // Select the output format from the output path, and open the output, in case of a stream format.
+  if (path == "-" || EndsWith(path, ".y4m")) format = Format::Y4m;
+  else if (path.find('%') != std::string::npos) format = Format::PpmSequence;
+  else format = Format::PpmStream;
+  if (format == Format::PpmSequence && !IsFramePathPattern(path)) {
+    throw std::runtime_error("Invalid video capture path pattern \"" + path + "\" (expected a single integer conversion, "
+                             "e.g. \"frames/%05d.ppm\", and any other '%' written as \"%%\").");
+  }
+  if (format != Format::PpmSequence) {
+    file = (path == "-")? stdout : std::fopen(path.c_str(), "wb");
+    if (file == nullptr) throw std::runtime_error("Video capture output \"" + path + "\" could not be opened.");
+  }
+
+  // A YUV4MPEG2 stream starts with a header holding the video properties (progressive frames with square pixels).
+  if (format == Format::Y4m) {
+    std::fprintf(file, "YUV4MPEG2 W%u H%u F%u:1 Ip A1:1 C420jpeg\n", width, height, frameRate);
+    yuv.resize((std::size_t) width * height + 2 * (std::size_t) ((width + 1) / 2) * ((height + 1) / 2));
+  }
+
+  for (std::size_t i = 0; i < buffers.size(); i++) freeBuffers.PushBack(i);
+  encoderThread = std::thread(&FrameEncoder::Encode, this);
+}
+
+FrameEncoder::~FrameEncoder() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  frameQueued.notify_one();
+  encoderThread.join();
+  if (file != nullptr && file != stdout) std::fclose(file);
+  else if (file != nullptr) std::fflush(file);
+}
+
+Uint8* FrameEncoder::AcquireFrame() {
+  std::unique_lock<std::mutex> lock(mutex);
+  bufferFreed.wait(lock, [this]() { return !freeBuffers.Empty() || encoderError; });
+  if (encoderError) std::rethrow_exception(encoderError);
+
+  acquiredBuffer = freeBuffers.Front();
+  freeBuffers.PopFront();
+  return buffers[acquiredBuffer].data();
+}
+
+void FrameEncoder::SubmitFrame() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    queuedBuffers.PushBack(acquiredBuffer);
+    submittedCnt++;
+  }
+  frameQueued.notify_one();
+}
+
+void FrameEncoder::Encode() {
+  unsigned long frameIdx = 0;
+  while (true) {
+    // Wait for the next queued frame (the remaining frames are still encoded once stopping).
+    std::size_t bufferIdx;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      frameQueued.wait(lock, [this]() { return !queuedBuffers.Empty() || stopping; });
+      if (queuedBuffers.Empty()) return;
+      bufferIdx = queuedBuffers.Front();
+      queuedBuffers.PopFront();
+    }
+
+    // Encode the frame with the mutex unlocked, then give its buffer back. After an error, frames are no longer written,
+    // and the error is forwarded to the capturing thread.
+    try {
+      WriteFrame(buffers[bufferIdx], frameIdx++);
+    } catch(...) {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!encoderError) encoderError = std::current_exception();
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      freeBuffers.PushBack(bufferIdx);
+    }
+    bufferFreed.notify_one();
+  }
+}
+
+void FrameEncoder::WriteFrame(const std::vector<Uint8>& rgb, const unsigned long frameIdx) {
+  if (encoderError) return;
+
+  if (format == Format::Y4m) {
+    ConvertToYuv(rgb);
+    std::fputs("FRAME\n", file);
+    if (std::fwrite(yuv.data(), 1, yuv.size(), file) != yuv.size()) {
+      throw std::runtime_error("Video capture frame could not be written to \"" + path + "\".");
+    }
+
+  } else if (format == Format::PpmStream) {
+    std::fprintf(file, "P6\n%u %u\n255\n", width, height);
+    if (std::fwrite(rgb.data(), 1, rgb.size(), file) != rgb.size()) {
+      throw std::runtime_error("Video capture frame could not be written to \"" + path + "\".");
+    }
+
+  } else {
+    // One file per frame, named after the frame index.
+    std::vector<char> pathBuffer(path.size() + 32);
+    std::snprintf(pathBuffer.data(), pathBuffer.size(), path.c_str(), (int) frameIdx);
+    const std::string framePath{pathBuffer.data()};
+    std::FILE *frameFile = std::fopen(framePath.c_str(), "wb");
+    if (frameFile == nullptr) throw std::runtime_error("Video capture file \"" + framePath + "\" could not be opened.");
+    std::fprintf(frameFile, "P6\n%u %u\n255\n", width, height);
+    const bool written = std::fwrite(rgb.data(), 1, rgb.size(), frameFile) == rgb.size();
+    if (std::fclose(frameFile) != 0 || !written) {
+      throw std::runtime_error("Video capture file \"" + framePath + "\" could not be written.");
+    }
+  }
+}
+
+void FrameEncoder::ConvertToYuv(const std::vector<Uint8>& rgb) {
+  const unsigned int chromaWidth = (width + 1) / 2;
+  const unsigned int chromaHeight = (height + 1) / 2;
+  Uint8 *yPlane = yuv.data();
+  Uint8 *uPlane = yPlane + (std::size_t) width * height;
+  Uint8 *vPlane = uPlane + (std::size_t) chromaWidth * chromaHeight;
+
+  // Luma of each pixel, in fixed point (with coefficients scaled by 2^16).
+  for (std::size_t i = 0; i < (std::size_t) width * height; i++) {
+    const int r = rgb[3 * i], g = rgb[3 * i + 1], b = rgb[3 * i + 2];
+    yPlane[i] = (Uint8) ((19595 * r + 38470 * g + 7471 * b + 32768) >> 16);
+  }
+
+  // Chroma of each 2x2 block of pixels (clamped at the right and bottom edges, for odd sizes), from its average color.
+  for (unsigned int cy = 0; cy < chromaHeight; cy++) {
+    for (unsigned int cx = 0; cx < chromaWidth; cx++) {
+      int r = 0, g = 0, b = 0;
+      for (unsigned int dy = 0; dy < 2; dy++) {
+        for (unsigned int dx = 0; dx < 2; dx++) {
+          const std::size_t i = (std::size_t) std::min(2 * cy + dy, height - 1) * width + std::min(2 * cx + dx, width - 1);
+          r += rgb[3 * i];
+          g += rgb[3 * i + 1];
+          b += rgb[3 * i + 2];
+        }
+      }
+      const std::size_t c = (std::size_t) cy * chromaWidth + cx;
+      uPlane[c] = (Uint8) std::clamp((-11059 * r - 21709 * g + 32768 * b + (128 << 18) + (1 << 17)) >> 18, 0, 255);
+      vPlane[c] = (Uint8) std::clamp((32768 * r - 27439 * g - 5329 * b + (128 << 18) + (1 << 17)) >> 18, 0, 255);
+    }
+  }
+}
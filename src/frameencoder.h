@@ -0,0 +1,168 @@
+#ifndef FRAMEENCODER_H
+#define FRAMEENCODER_H
+
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+#include "SDL.h"
+#include "ringbuffer.h"
+
+/**
+ *  \brief Class writing captured frames (as RGB24 pixels) to a video file or pipe, encoding them in a background thread so
+ * that capturing doesn't hold the rendering thread back. Frames are handed over through a fixed pool of preallocated
+ * buffers: once all of them are queued, the capturing thread waits for the encoder to free one, so no frame is dropped.
+ * The output format is selected from the output path:
+ * - "-" or a path ending in ".y4m": a YUV4MPEG2 stream (4:2:0 chroma, full range), readable by e.g. ffmpeg and mpv;
+ * - a path with a printf-style integer conversion (e.g. "frames/%05d.ppm"): one binary PPM file per frame;
+ * - any other path: a stream of concatenated binary PPM images (e.g. a pipe into "ffmpeg -f image2pipe").
+ */
+class FrameEncoder {
+ public:
+  /**
+   *  \brief Output format enum: YUV4MPEG2 stream, PPM files sequence, or concatenated PPM images stream.
+   */
+  enum class Format { Y4m, PpmSequence, PpmStream };
+
+  /**
+   *  \brief Constructor of the FrameEncoder class object. Opens the output and starts the encoder thread.
+   * If the output can't be opened, or if a path with '%' characters isn't a valid frame file pattern (i.e. with a single
+   * "%d" conversion, optionally with flags and width, and any other '%' written as "%%"), a runtime exception is raised.
+   *  \param path The output path ("-" for the standard output).
+   *  \param width Width of the frames, in pixels.
+   *  \param height Height of the frames, in pixels.
+   *  \param frameRate Frame rate of the recorded video, in frames per second.
+   *  \param bufferCnt Number of frame buffers, i.e. frames that can be queued for encoding.
+   */
+  FrameEncoder(const std::string& path, const unsigned int width, const unsigned int height, const unsigned int frameRate,
+               const unsigned int bufferCnt);
+
+  /**
+   *  \brief Destructor of the FrameEncoder class object. Encodes the queued frames, then stops the encoder thread and closes
+   * the output.
+   */
+  ~FrameEncoder();
+
+  /**
+   *  \brief Takes a free frame buffer, to be filled with the next frame's RGB24 pixels (3 bytes per pixel, row by row, with
+   * no padding) and then submitted. Waits for the encoder to free a buffer, in case all of them are queued.
+   * If the encoder failed to write a previous frame, its error is raised.
+   *  \return Pointer to the buffer's pixels, GetWidth() * GetHeight() * 3 bytes long.
+   */
+  Uint8* AcquireFrame();
+
+  /**
+   *  \brief Queues the frame buffer taken by the latest AcquireFrame call for encoding.
+   */
+  void SubmitFrame();
+
+  /**
+   *  \brief Returns the number of frames submitted so far.
+   *  \return Number of captured frames.
+   */
+  unsigned long GetFrameCnt() const { return submittedCnt; }
+
+  /**
+   *  \brief Returns the width of the frames.
+   *  \return Width, in pixels.
+   */
+  unsigned int GetWidth() const { return width; }
+
+  /**
+   *  \brief Returns the height of the frames.
+   *  \return Height, in pixels.
+   */
+  unsigned int GetHeight() const { return height; }
+
+ private:
+  /**
+   *  \brief Encoder thread routine: writes the queued frames in order, until the encoder is destroyed and its queue is empty.
+   */
+  void Encode();
+
+  /**
+   *  \brief Writes a frame to the output, in the selected format.
+   *  \param rgb The frame's RGB24 pixels.
+   *  \param frameIdx Index of the frame, from 0.
+   */
+  void WriteFrame(const std::vector<Uint8>& rgb, const unsigned long frameIdx);
+
+  /**
+   *  \brief Converts RGB24 pixels to planar YUV 4:2:0 (full range BT.601, as in JPEG), into the yuv buffer. Each chroma
+   * sample is the average of a 2x2 block of pixels.
+   *  \param rgb The frame's RGB24 pixels.
+   */
+  void ConvertToYuv(const std::vector<Uint8>& rgb);
+
+  /**
+   *  \brief The output path, and the selected output format.
+   */
+  const std::string path;
+  Format format;
+
+  /**
+   *  \brief The output file (or the standard output), for stream formats.
+   */
+  std::FILE *file{nullptr};
+
+  /**
+   *  \brief Frames width, height and rate.
+   */
+  const unsigned int width;
+  const unsigned int height;
+  const unsigned int frameRate;
+
+  /**
+   *  \brief The frame buffers, and the indexes of the free and of the queued ones (in submission order).
+   */
+  std::vector<std::vector<Uint8>> buffers;
+  RingBuffer<std::size_t> freeBuffers;
+  RingBuffer<std::size_t> queuedBuffers;
+
+  /**
+   *  \brief Index of the buffer taken by the latest AcquireFrame call (only accessed by the capturing thread).
+   */
+  std::size_t acquiredBuffer{0};
+
+  /**
+   *  \brief Planar YUV 4:2:0 conversion buffer (only accessed by the encoder thread).
+   */
+  std::vector<Uint8> yuv;
+
+  /**
+   *  \brief Mutex protecting the buffer queues and the encoder state.
+   */
+  std::mutex mutex;
+
+  /**
+   *  \brief Conditions notified when a frame is queued (or the encoder is stopping), and when a buffer is freed.
+   */
+  std::condition_variable frameQueued;
+  std::condition_variable bufferFreed;
+
+  /**
+   *  \brief Flag indicating if the encoder is being destroyed.
+   */
+  bool stopping{false};
+
+  /**
+   *  \brief Error raised by the encoder thread (if any), forwarded to the capturing thread.
+   */
+  std::exception_ptr encoderError;
+
+  /**
+   *  \brief Number of frames submitted.
+   */
+  unsigned long submittedCnt{0};
+
+  /**
+   *  \brief The encoder thread.
+   */
+  std::thread encoderThread;
+};
+
+#endif
@@ -0,0 +1,155 @@
+#ifndef FRAMESNAPSHOT_H
+#define FRAMESNAPSHOT_H
+
+#include <vector>
+
+#include "SDL.h"
+#include "world.h"
+
+/**
+ *  \brief Motion state of a snake, used to interpolate its head and tail positions between simulation steps.
+ */
+struct SnakeMotion {
+  /**
+   *  \brief Grid positions of the snake's head, and of the next tile in the head direction.
+   */
+  SDL_Point head;
+  SDL_Point headNext;
+
+  /**
+   *  \brief Grid positions of the snake's tail, and of the body part next to it (equal to the tail, if the snake is only
+   * made of its head).
+   */
+  SDL_Point tail;
+  SDL_Point tailNext;
+
+  /**
+   *  \brief The head's progress towards the next tile at the snapshot step, in sub-tile motion ticks.
+   */
+  unsigned int ticks;
+
+  /**
+   *  \brief The snake speed, in sub-tile motion ticks per simulation step.
+   */
+  unsigned int speed;
+};
+
+/**
+ *  \brief Immutable copy of everything needed to render one frame, published by the simulation thread to the main
+ * (rendering) thread, so that the latter never reads the live game state.
+ */
+struct FrameSnapshot {
+  /**
+   *  \brief Sequence number of the snapshot, incremented at each publication, so that the renderer can detect skipped
+   * snapshots (whose changed tiles it has missed).
+   */
+  unsigned long sequence{0};
+
+  /**
+   *  \brief Indicates if the whole grid shall be repainted (e.g. after switching the rendered world), instead of only the
+   * changed tiles.
+   */
+  bool fullRedraw{true};
+
+  /**
+   *  \brief The rendered world's grid side length, in number of grid cells.
+   */
+  unsigned int gridSideLen{0};
+
+  /**
+   *  \brief Copy of the rendered world's grid, in row-major order.
+   */
+  std::vector<World::Element> grid;
+
+  /**
+   *  \brief Grid tiles changed since the previous snapshot.
+   */
+  std::vector<SDL_Point> changedTiles;
+
+  /**
+   *  \brief Motion state of the alive snakes in the rendered world.
+   */
+  std::vector<SnakeMotion> snakes;
+
+  /**
+   *  \brief Number of sub-tile motion ticks needed to cross one grid tile.
+   */
+  unsigned int ticksPerTile{1};
+
+  /**
+   *  \brief Time of the latest simulation step included in the snapshot, as a performance counter value.
+   */
+  Uint64 stepTimestamp{0};
+
+  /**
+   *  \brief Simulation step period, in performance counter ticks, used to extrapolate the snakes' motion since the
+   * snapshot step. Set to 0 if the snakes aren't moving at a steady rate (e.g. while paused or in speed mode).
+   */
+  Uint64 stepPeriod{0};
+
+  /**
+   *  \brief Current score.
+   */
+  unsigned int score{0};
+
+  /**
+   *  \brief Maximum score that has been achieved by the player.
+   */
+  unsigned int maxScorePlayer{0};
+
+  /**
+   *  \brief Maximum score that has been achieved by the snake AI.
+   */
+  unsigned int maxScoreAI{0};
+
+  /**
+   *  \brief Current genetic algorithm generation.
+   */
+  unsigned int genCnt{0};
+
+  /**
+   *  \brief Current genetic algorithm individual.
+   */
+  unsigned int indCnt{0};
+
+  /**
+   *  \brief Number of simulation steps run in the latest second.
+   */
+  unsigned int stepsPerSec{0};
+
+  /**
+   *  \brief Number of player turns taken in the latest second, and their mean and maximum input latencies (i.e. time from
+   * the key press until the snake turns), in milliseconds.
+   */
+  unsigned int turnCnt{0};
+  unsigned int meanInputLatencyMs{0};
+  unsigned int maxInputLatencyMs{0};
+
+  /**
+   *  \brief Flag indicating if the AI is being trained in the background (in manual mode), in which case the genetic 
+   * algorithm generation and individual are the background training ones.
+   */
+  bool backgroundTraining{false};
+
+  /**
+   *  \brief Flags indicating if the game is in auto mode, paused, with the AI lookahead search on, in arena mode, in mosaic
+   * mode, and in speed mode (i.e. with no simulation rate control), respectively.
+   */
+  bool automode{false};
+  bool paused{false};
+  bool lookahead{false};
+  bool arenaMode{false};
+  bool mosaicMode{false};
+  bool speedMode{false};
+
+  /**
+   *  \brief Flag indicating if the game is in champion showcase mode, and, if so, whether a champion is being replayed, 
+   * along with its generation and score.
+   */
+  bool showcaseMode{false};
+  bool championReady{false};
+  unsigned int championGen{0};
+  unsigned int championScore{0};
+};
+
+#endif
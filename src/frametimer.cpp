@@ -0,0 +1,73 @@
+#include "frametimer.h"
+#include <cmath>
+#include <algorithm>
+#include <thread>
+#include "config.h"
+
+FrameTimer::FrameTimer(const unsigned int targetRate)
+  : frequency(SDL_GetPerformanceFrequency()),
+    periodTicks(frequency / std::max(targetRate, (unsigned int) 1)),
+    spinMarginTicks(frequency * FRAME_SPIN_MARGIN_US / 1000000),
+    deadline(SDL_GetPerformanceCounter() + periodTicks),
+    lastFrameEnd(SDL_GetPerformanceCounter()) {}
+
+void FrameTimer::WaitUntil(const Uint64 target) const {
+  // Sleep in millisecond steps while the deadline is farther than the spin margin.
+  Uint64 now = Now();
+  while (now + spinMarginTicks < target) {
+    SDL_Delay((Uint32) std::max<Uint64>(1, (target - now - spinMarginTicks) * 1000 / frequency));
+    now = Now();
+  }
+
+  // Then, spin for the remaining time, yielding the CPU to other threads in between.
+  while (now < target) {
+    std::this_thread::yield();
+    now = Now();
+  }
+}
+
+void FrameTimer::WaitNextFrame() {
+  const Uint64 now = Now();
+  if (now >= deadline + periodTicks) {
+    // More than one period late: start over from now, instead of running the next iterations back to back.
+    deadline = now;
+  } else {
+    WaitUntil(deadline);
+  }
+
+  RecordFrame(Now());
+  deadline += periodTicks;
+}
+
+void FrameTimer::Restart() {
+  lastFrameEnd = Now();
+  deadline = lastFrameEnd + periodTicks;
+}
+
+FrameTimer::Stats FrameTimer::GetStats() const {
+  Stats stats;
+  stats.frameCnt = frameCnt;
+  if (frameCnt > 0) {
+    stats.meanPeriodMs = periodSumMs / frameCnt;
+    stats.jitterMs = std::sqrt(std::max(0.0, periodSqSumMs / frameCnt - stats.meanPeriodMs * stats.meanPeriodMs));
+    stats.maxDeviationMs = maxDeviationMs;
+  }
+  return stats;
+}
+
+void FrameTimer::ResetStats() {
+  frameCnt = 0;
+  periodSumMs = 0;
+  periodSqSumMs = 0;
+  maxDeviationMs = 0;
+}
+
+void FrameTimer::RecordFrame(const Uint64 now) {
+  const double periodMs = ToMs(now - lastFrameEnd);
+  lastFrameEnd = now;
+
+  frameCnt++;
+  periodSumMs += periodMs;
+  periodSqSumMs += periodMs * periodMs;
+  maxDeviationMs = std::max(maxDeviationMs, std::fabs(periodMs - ToMs(periodTicks)));
+}
@@ -0,0 +1,136 @@
+#ifndef FRAMETIMER_H
+#define FRAMETIMER_H
+
+#include "SDL.h"
+
+/**
+ *  \brief Class pacing a loop at a fixed rate with the high-resolution performance counter, and keeping timing statistics
+ * of the loop iterations (e.g. to expose frame pacing jitter).
+ * Waits are hybrid: the thread sleeps while the deadline is far, and spins only for the last moments, since sleeping
+ * alone wakes up with a scheduler-dependent delay.
+ */
+class FrameTimer {
+ public:
+  /**
+   *  \brief Timing statistics of the iterations recorded since the latest reset.
+   */
+  struct Stats {
+    /**
+     *  \brief Number of recorded iterations.
+     */
+    unsigned int frameCnt{0};
+
+    /**
+     *  \brief Mean iteration period, in milliseconds.
+     */
+    double meanPeriodMs{0};
+
+    /**
+     *  \brief Jitter, as the standard deviation of the iteration period, in milliseconds.
+     */
+    double jitterMs{0};
+
+    /**
+     *  \brief Maximum absolute deviation of an iteration period from the target period, in milliseconds.
+     */
+    double maxDeviationMs{0};
+  };
+
+  /**
+   *  \brief Constructor of the FrameTimer class object. The first deadline is one period after the construction.
+   *  \param targetRate Target loop rate, in iterations per second.
+   */
+  FrameTimer(const unsigned int targetRate);
+
+  /**
+   *  \brief Returns the current time.
+   *  \return Current performance counter value, in counter ticks.
+   */
+  Uint64 Now() const { return SDL_GetPerformanceCounter(); }
+
+  /**
+   *  \brief Returns the target loop period.
+   *  \return Target period, in performance counter ticks.
+   */
+  Uint64 GetPeriod() const { return periodTicks; }
+
+  /**
+   *  \brief Converts a duration from performance counter ticks to milliseconds.
+   *  \param ticks The duration, in performance counter ticks.
+   *  \return The duration, in milliseconds.
+   */
+  double ToMs(const Uint64 ticks) const { return 1000.0 * ticks / frequency; }
+
+  /**
+   *  \brief Waits until a given time (sleeping, then spinning), returning immediately if it has already passed.
+   *  \param target The time to wait for, as a performance counter value.
+   */
+  void WaitUntil(const Uint64 target) const;
+
+  /**
+   *  \brief Waits for the next iteration deadline, one target period after the previous one, and records the iteration
+   * period. If the loop has fallen more than one period behind, the deadlines are re-synchronized to the current time,
+   * instead of rushing iterations to catch up.
+   */
+  void WaitNextFrame();
+
+  /**
+   *  \brief Restarts the iteration deadlines from the current time, without recording an iteration (e.g. when the loop 
+   * resumes after being idle, so that the idle time doesn't count as a late iteration).
+   */
+  void Restart();
+
+  /**
+   *  \brief Computes the timing statistics of the iterations recorded since the latest reset.
+   *  \return The timing statistics.
+   */
+  Stats GetStats() const;
+
+  /**
+   *  \brief Clears the recorded timing statistics.
+   */
+  void ResetStats();
+
+ private:
+  /**
+   *  \brief Records the period of the iteration ending at the given time.
+   *  \param now The iteration end time, as a performance counter value.
+   */
+  void RecordFrame(const Uint64 now);
+
+  /**
+   *  \brief Performance counter frequency, in ticks per second.
+   */
+  const Uint64 frequency;
+
+  /**
+   *  \brief Target loop period, in performance counter ticks.
+   */
+  const Uint64 periodTicks;
+
+  /**
+   *  \brief Time margin before a deadline, in performance counter ticks, within which the thread spins instead of sleeping.
+   */
+  const Uint64 spinMarginTicks;
+
+  /**
+   *  \brief The next iteration deadline, as a performance counter value.
+   */
+  Uint64 deadline;
+
+  /**
+   *  \brief End time of the latest recorded iteration, as a performance counter value.
+   */
+  Uint64 lastFrameEnd;
+
+  /**
+   *  \brief Accumulators of the recorded iteration periods (count, sum and sum of squares, in milliseconds) and maximum
+   * absolute deviation from the target period (in milliseconds).
+   */
+  unsigned int frameCnt{0};
+  double periodSumMs{0};
+  double periodSqSumMs{0};
+  double maxDeviationMs{0};
+};
+
+#endif
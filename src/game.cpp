@@ -4,9 +4,15 @@
 #include <cstdio>
 #include <algorithm>
 #include <climits>
+#include <cmath>
+#include <chrono>
 #include "SDL.h"
 #include "clip.h"
 #include "config.h"
+#include "frametimer.h"
+#include "profiler.h"
+#include "tracer.h"
+#include "allocstats.h"
 
 /**
  *  \brief Clip grid size length at INT_MAX. 
@@ -16,172 +22,501 @@
  */
 #define CLIP_GRID_SIDE_LEN(a) ((unsigned int) std::min<unsigned int>(a, (unsigned int) INT_MAX))
 
-Game::Game(const unsigned int winWidth, const unsigned int winHeight, const unsigned int gridSideLen) 
-  : renderer(winWidth, winHeight, CLIP_GRID_SIDE_LEN(gridSideLen)),
+Game::Game(const unsigned int winWidth, const unsigned int winHeight, const unsigned int gridSideLen, 
+           const Game::Options& options) 
+  : renderer(winWidth, winHeight, CLIP_GRID_SIDE_LEN(gridSideLen), options.headless),
     world(CLIP_GRID_SIDE_LEN(gridSideLen)),
-    snake(SDL_Point{(int) CLIP_GRID_SIDE_LEN(gridSideLen)/2, (int) CLIP_GRID_SIDE_LEN(gridSideLen)/2}, world) {}
+    options(options),
+    eventLog((options.eventLogPath.empty())? nullptr : std::make_unique<EventLog>(options.eventLogPath, EVENT_LOG_CAPACITY)),
+    snake(SDL_Point{(int) CLIP_GRID_SIDE_LEN(gridSideLen)/2, (int) CLIP_GRID_SIDE_LEN(gridSideLen)/2}, world),
+    arena(ARENA_SNAKES_CNT, CLIP_GRID_SIDE_LEN(ARENA_GRID_SIDE_LENGTH), ARENA_SHARED_FOOD, snake.GetGenAlg(),
+          eventLog.get()),
+    mosaic(MOSAIC_GAMES_CNT, CLIP_GRID_SIDE_LEN(MOSAIC_GRID_SIDE_LENGTH), snake.GetGenAlg(), eventLog.get()),
+    trainer(BACKGROUND_TRAINING_WORKERS, CLIP_GRID_SIDE_LEN(gridSideLen), snake.GetGenAlg(), eventLog.get()),
+    seedGenerator(std::chrono::system_clock::now().time_since_epoch().count()) {
+  if (!options.statsPath.empty()) snake.GetGenAlg()->SetStatsFile(options.statsPath);
+}
 
-void Game::Run(const unsigned int targetFramePeriod) {
+void Game::Run(const unsigned int targetFrameRate, const unsigned int targetStepRate) {
   // Try to load previous game state from save file, in case there's one available.
   // If not, game will start from beginning.
   LoadSaveFile();
 
-  // Set game running state to true.
-  running = true;
-
-  // Declare and initialize variables to be used in the game main loop.
-  unsigned int titleUpdTimestamp = SDL_GetTicks();
-  unsigned int frameStart;
-  unsigned int frameEnd;
-  unsigned int frameDuration;
-  unsigned int frameRateCnt = 0;
-
-  // Main game loop, while running flag is still true
-  while (running) {
-    // Store the timestamp for the beginning of the frame.
-    frameStart = SDL_GetTicks();
+  // Start the first round (from a recorded world seed, as any other one).
+  this->NewRound();
 
-    // Receive Input, Update, Render - the main game loop
-    UpdateState(controller.ReceiveCommand());
-    renderer.Render(world);
+  // Show the game controls summary until the player presses a key (unless headless, with no player to press it).
+  if (!options.headless) ShowNotification("The Snake Game will begin!\n"
+    "Please find the game controls summary below:\n"
+    "- Arrow keys: controls the snake in Manual mode (i.e. player in control);\n"
+    "- 'A' key: toggles Auto mode (i.e. AI in control) on and off;\n"
+    "- 'S' key: toggles Speed mode (i.e. no frame rate control) on and off (obs.: only available in Auto mode);\n"
+    "- 'P' key: pauses the game (or resumes it);\n"
+    "- 'E' key: erases and resets all game data, inclusing record scores and AI learning;\n"
+    "- 'L' key: toggles the AI lookahead search on and off (obs.: only affects Auto mode);\n"
+    "- 'M' key: toggles Arena mode (i.e. several AI snakes sharing a larger world) on and off (obs.: only available in "
+      "Auto mode);\n"
+    "- 'G' key: toggles Mosaic mode (i.e. a grid of AI games played at once, each one in its own world) on and off (obs.: "
+      "only available in Auto mode);\n"
+    "- 'C' key: toggles Champion showcase mode (i.e. the AI trains at full speed in the background, while each "
+      "generation's best snake is replayed) on and off (obs.: only available in Auto mode);\n"
+    "- 'Y'/'N' keys: answers questions shown in the game window (or Enter/Escape for the default answer);\n"
+    "- Close game window: ends the game and exit.\n\n"
+    "Press any key to start.", true);
+
+  // The game starts in manual mode, while the AI trains in the background, or in auto mode showcasing the champions, if 
+  // so requested.
+  if (options.showcase) {
+    if (!snake.IsAutoModeOn()) snake.ProcessUserCommand(Controller::TimedCommand{Controller::UserCommand::ToggleAutoMode, 0});
+    SetShowcaseMode(true);
+  }
+  UpdateTraining();
 
-    // Increment the fps count.
-    frameRateCnt = CLPD_UINT_SUM(frameRateCnt, 1);
+  // Frames are rendered at the display refresh rate, if it's known, or at the target frame rate otherwise.
+  const unsigned int frameRate = (renderer.GetDisplayRefreshRate() > 0)? renderer.GetDisplayRefreshRate() : targetFrameRate;
 
-    // Get the timestamp after all game update and rendering processing has finished.
-    frameEnd = SDL_GetTicks();
+  // Capture the rendered frames, if requested, at the frame rate they're rendered at.
+  const bool capturing = !options.capturePath.empty();
+  if (capturing) {
+    frameEncoder = std::make_unique<FrameEncoder>(options.capturePath, renderer.GetWindowWidth(), renderer.GetWindowHeight(), 
+                                                  frameRate, FRAME_CAPTURE_BUFFERS);
+    renderer.SetCaptureEncoder(frameEncoder.get());
+  }
 
-    // Calculate the duration of the last frame.
-    frameDuration = CLPD_UINT_DIFF(frameEnd, frameStart);
+  // Set game running state to true, and start the simulation thread.
+  running = true;
+  simThread = std::thread(&Game::Simulate, this, targetStepRate, frameRate);
+
+  // Declare and initialize variables to be used in the main (rendering) loop.
+  FrameTimer frameTimer(frameRate);
+  Uint64 titleUpdTimestamp = frameTimer.Now();
+  bool frameAvailable = false;
+  bool idle = false;
+  bool redrawRequested = false;
+  Uint32 idleTimeoutMs = IDLE_WAIT_TIMEOUT_MS;
+  unsigned long renderedOverlayRevision = overlayRevision - 1;
+
+  try {
+    // Main loop, while running flag is still true
+    while (running) {
+      // Receive Input (sleeping until an input arrives, if the game is idle), process every command received (in the 
+      // order they were issued), dismiss any expired notification, then check if the player's round is over (in manual 
+      // mode).
+      TRACE_SPAN(inputSpan, "input");
+      ALLOC_SCOPE(frameAllocs);
+      const bool wasIdle = idle;
+      if (idle) controller.WaitCommands(idleTimeoutMs);
+      else controller.ReceiveCommands();
+      bool stateChangedByPlayer = false;
+      {
+        std::unique_lock<std::mutex> lock = LockState();
+        Controller::TimedCommand command;
+        while (controller.PopCommand(command)) {
+          if (command.command == Controller::UserCommand::Redraw) redrawRequested = true;
+          else ProcessCommand(command);
+          stateChangedByPlayer = true;
+        }
+        if (overlay.kind == Overlay::Kind::Notification && overlay.durationMs > 0 
+            && SDL_GetTicks() - overlay.shownTimestamp >= overlay.durationMs) {
+          HideOverlay();
+        }
+        CheckPlayerRoundEnd();
+
+        // The game is idle while the simulation is halted, or while its window is hidden (unless capturing). Idle waits 
+        // for input end in time to dismiss a shown notification.
+        windowHidden = renderer.IsWindowHidden();
+        idle = (IsHalted() || windowHidden) && !capturing;
+        idleTimeoutMs = IDLE_WAIT_TIMEOUT_MS;
+        if (overlay.kind == Overlay::Kind::Notification && overlay.durationMs > 0) {
+          const Uint32 shownMs = SDL_GetTicks() - overlay.shownTimestamp;
+          idleTimeoutMs = std::min<Uint32>(idleTimeoutMs, (shownMs < overlay.durationMs)? overlay.durationMs - shownMs : 0);
+        }
+        if (stateChangedByPlayer) stateRevision++;
+      }
 
-    // After every second, update the window title.
-    if ( CLPD_UINT_DIFF(frameEnd, titleUpdTimestamp) >= 1000) {
-      renderer.UpdateWindowTitle(this->GetScore(), frameRateCnt, this->maxScorePlayer,
-        snake.IsAutoModeOn(), this->maxScoreAI, snake.GetGenAlgGeneration(), 
-        snake.GetGenAlgIndividual(), this->paused);
+      // Wake the simulation thread up, in case it's sleeping while halted.
+      if (stateChangedByPlayer) stateChanged.notify_all();
+      TRACE_SPAN_END(inputSpan);
+
+      // Render the latest frame snapshot published by the simulation thread (once the first one is available), with the
+      // snakes' motion interpolated up to the current time, and the overlay (only changed by this thread) on top.
+      // Nothing is rendered while the window is hidden, nor when nothing visible changed since the previous frame (i.e.
+      // no new snapshot, no motion to interpolate, and the same overlay), unless every frame is captured.
+      const bool newFrame = frames.Consume();
+      frameAvailable = frameAvailable || newFrame;
+      if (frameAvailable && (!windowHidden || capturing)) {
+        const FrameSnapshot& frame = frames.GetFrontBuffer();
+        if (newFrame || frame.stepPeriod > 0 || overlayRevision != renderedOverlayRevision || redrawRequested || capturing) {
+          TRACE_SCOPE("render");
+          renderer.Render(frame, frameTimer.Now(), overlay);
+          renderedOverlayRevision = overlayRevision;
+          redrawRequested = false;
+        }
+      }
 
-      // Reset the fps count.
-      frameRateCnt = 0;
+      // End the game once the requested number of frames was captured.
+      if (capturing && options.captureFrameLimit > 0 && frameEncoder->GetFrameCnt() >= options.captureFrameLimit) {
+        running = false;
+      }
 
-      // Reset the title update timestamp.
-      titleUpdTimestamp = frameEnd;
-    }
+      // After every second, update the window title with the frame rate and its jitter, and restart the timing stats.
+      const Uint64 now = frameTimer.Now();
+      const double elapsedMs = frameTimer.ToMs(now - titleUpdTimestamp);
+      if (elapsedMs >= 1000) {
+        const FrameTimer::Stats stats = frameTimer.GetStats();
+        const unsigned int fps = (unsigned int) std::lround(stats.frameCnt * 1000.0 / elapsedMs);
+        if (frameAvailable && trainer.IsActive()) {
+          // The background training goes on while the simulation is halted (and no snapshots are published), so its
+          // progress is taken from the trainer itself.
+          FrameSnapshot frame = frames.GetFrontBuffer();
+          frame.genCnt = trainer.GetGenerationCnt();
+          frame.indCnt = trainer.GetIndividualCnt();
+          frame.maxScoreAI = std::max(frame.maxScoreAI, trainer.GetMaxScore());
+          renderer.UpdateWindowTitle(frame, fps, stats.jitterMs);
+        } else if (frameAvailable) {
+          renderer.UpdateWindowTitle(frames.GetFrontBuffer(), fps, stats.jitterMs);
+        }
+        frameTimer.ResetStats();
+        titleUpdTimestamp = now;
+      }
 
-    // If the time for the current frame was too small (i.e. frameDuration is smaller than the target frame period), 
-    // delay the loop to achieve the correct frame rate.
-    // This is only done if frame rate control is active.
-    if (fpsCtrlActv == true && frameDuration < targetFramePeriod) {
-      SDL_Delay(CLPD_UINT_DIFF(targetFramePeriod, frameDuration));
+      // Unless idle, frames are always rendered at the target frame rate (even in speed mode, where only the simulation 
+      // runs faster), so wait for the next frame deadline (restarting the deadlines when leaving the idle state).
+      if (!idle && wasIdle) {
+        frameTimer.Restart();
+      } else if (!idle) {
+        TRACE_SCOPE("delay");
+        frameTimer.WaitNextFrame();
+      }
+      ALLOC_RECORD(Frame, frameAllocs);
     }
+  } catch(...) {
+    // Stop the simulation thread before leaving.
+    StopSimulation();
+    throw;
+  }
 
-    // If the game is paused, skip automode time countdown and game round end check.
-    if (!paused) {
-      
-      if (snake.IsAutoModeOn()) {
+  // Wait for the simulation thread to finish, and forward any error it ran into.
+  StopSimulation();
+  if (simException) std::rethrow_exception(simException);
 
-        // If the snake is dead or won the game, do the necessary processing in order to start a new game round.
-        if (!snake.IsAlive() || victory) {
-          // Try to update the maximum game score, in case a record was achieved.
-          this->maxScoreAI = std::max(this->maxScoreAI, this->GetScore());
-
-          // Update the fitness of the current individual in the Genetic Algorithm population, which then moves 
-          // it to the next individual.
-          // Set the fitness as equal to the snake size/score.
-          // Obs.: this is only done in case the CPU controlled the snake from start to finish of the game, 
-          // otherwise the result doesn't count for the snake AI learning (in case the snake was controlled by 
-          // the player at any point of time).
-          snake.GradeFitness((float) snake.GetSize());
-
-          // Reset the game and start a new round.
-          this->NewRound();
-        }
+  // Finish encoding the captured frames.
+  renderer.SetCaptureEncoder(nullptr);
+  frameEncoder.reset();
 
-      } else if (victory || !snake.IsAlive()) {
-        // Else if snake is being controlled by the player and current round has ended...
+  // Stores the game state in a save file, for it to be resumed in the next execution (once the background training no 
+  // longer changes it).
+  trainer.Pause();
+  StoreSaveFile();
 
-        if (victory) {
-          // If the player won the round, display a special congratulating message.
-          // Try to update the record player score.
-          this->maxScorePlayer = std::max(this->maxScorePlayer, this->GetScore());
+  // Write the final snapshot of the instrumentation statistics (only in instrumentation builds).
+  PROFILE_DUMP(std::cerr);
+}
 
-          // Display victory congratulating message.
-          std::string message = "Congratulations for getting past all obstacles and growing to the max," 
-            " you've completed the game!! :)";
-          int msgNotOk = SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_INFORMATION, "The Snake Game", message.c_str(), NULL);
-          if (msgNotOk) throw std::runtime_error("Error during display of game's victory message box.");
+void Game::Simulate(const unsigned int targetStepRate, const unsigned int frameRate) {
+  TRACE_THREAD_NAME("simulation");
+  try {
+    FrameTimer stepTimer(targetStepRate);
+    const Uint64 stepPeriod = stepTimer.GetPeriod();
+    const Uint64 framePeriod = FrameTimer(frameRate).GetPeriod();
+    Uint64 prevTimestamp = stepTimer.Now();
+    Uint64 publishTimestamp = 0;
+    Uint64 rateTimestamp = prevTimestamp;
+    Uint64 accumulator = 0;
+    bool haltPublished = false;
+
+    while (running) {
+      // Accumulate the time elapsed since the previous iteration, which is then consumed in fixed-length steps.
+      const Uint64 now = stepTimer.Now();
+      accumulator += now - prevTimestamp;
+      prevTimestamp = now;
+
+      bool speedMode;
+      {
+        std::unique_lock<std::mutex> lock(stateMutex);
+
+        // No game time elapses while halted. Once the halted game has been published, sleep until the player changes 
+        // the game state, instead of publishing the same snapshot at every step period.
+        const bool halted = IsHalted();
+        if (halted && haltPublished) {
+          const unsigned long revision = stateRevision;
+          stateChanged.wait(lock, [this, revision]() { return !running || stateRevision != revision; });
+          prevTimestamp = stepTimer.Now();
+          haltPublished = false;
+          continue;
+        }
 
+        // The AI also runs in speed mode while the window is hidden, if so configured (except for the champion replays, 
+        // which are only meant to be watched).
+        speedMode = (!fpsCtrlActv || (HIDDEN_WINDOW_SPEED_MODE && windowHidden && snake.IsAutoModeOn() && !showcaseMode)) 
+          && !halted;
+        if (halted) {
+          accumulator = 0;
+        } else if (speedMode) {
+          // In speed mode, steps aren't bound to the elapsed time, and run as fast as possible.
+          UpdateState();
+          stepCnt++;
+          accumulator = 0;
         } else {
-          // Else if the player collided, check for the score.
-          // If the score is a new record, display a special congratulating message.
-          if (this->GetScore() > this->maxScorePlayer) {
-            // Display congratulating message for the new game record.
-            std::string message = "You've set a new record, congratulations!\nPrior player record score: " +
-              std::to_string(this->maxScorePlayer) + "\nNew player record score: " + std::to_string(this->GetScore());
-            int msgNotOk = SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_INFORMATION, "The Snake Game", message.c_str(), NULL);
-            if (msgNotOk) throw std::runtime_error("Error during display of game's new record message box.");
-
-            // Update player record score.
-            this->maxScorePlayer = this->GetScore();
+          // Otherwise, run one step per elapsed step period. After a stall (e.g. while the main thread held the game 
+          // state), only a limited number of steps is run to catch up, and the excess time is dropped.
+          accumulator = std::min<Uint64>(accumulator, SIM_MAX_CATCHUP_STEPS * stepPeriod);
+          TRACE_SCOPE("update");
+          while (accumulator >= stepPeriod) {
+            UpdateState();
+            stepCnt++;
+            accumulator -= stepPeriod;
           }
         }
 
-        // Ask if the player wants to play a new game round
-        Game::ConfirmationBoxButtonId selection = this->ShowConfirmationBox(
-          "Play again?",
-          "Error during the display of \"play again?\" question window.",
-          true // 'Yes' as default option
-        );
+        // Publish a frame snapshot at every iteration, or, in speed mode, once per frame period only (as frames aren't
+        // rendered any faster than that). The latest step happened when the accumulated time was last consumed. In speed 
+        // mode, only the publishing is traced (once per frame period), as tracing every single step would flood the trace.
+        if (!speedMode || now - publishTimestamp >= framePeriod) {
+          TRACE_SCOPE("publish");
+          PublishFrame(now - accumulator, (halted || speedMode)? 0 : stepPeriod);
+          publishTimestamp = now;
+          haltPublished = halted;
+        }
 
-        if (selection == Game::ConfirmationBoxButtonId::Yes) {
-          // Start a new game round.
-          this->NewRound();
-        } else {
-          // End the game
-          this->running = false;
+        // Keep the AI record score up to date with the background training.
+        this->maxScoreAI = std::max(this->maxScoreAI, trainer.GetMaxScore());
+
+        // After every second, update the simulation steps rate and the player's input latency.
+        if (stepTimer.ToMs(now - rateTimestamp) >= 1000) {
+          stepsPerSec = stepCnt;
+          stepCnt = 0;
+          inputLatency = snake.GetInputLatency();
+          snake.ResetInputLatency();
+          rateTimestamp = now;
         }
       }
+
+      // Let the main thread take the game state lock, in case it's waiting for it.
+      while (stateRequested && running) std::this_thread::yield();
+
+      // Unless in speed mode, wait until the accumulated time reaches a full step period again.
+      if (!speedMode) stepTimer.WaitUntil(prevTimestamp + stepPeriod - accumulator);
     }
+  } catch(...) {
+    // Hand the error over to the main thread, and end the game.
+    simException = std::current_exception();
+    running = false;
   }
+}
 
-  // Stores the game state in a save file, for it to be resumed in the next execution.
-  StoreSaveFile();
+SnakeMotion Game::GetSnakeMotion(const Snake& snake) {
+  const RingBuffer<SDL_Point>& positions = snake.GetPositions();
+  SnakeMotion motion;
+  motion.head = positions.Front();
+  motion.headNext = GetAdjPosition(motion.head, snake.GetDirection());
+  motion.tail = positions.Back();
+  motion.tailNext = (positions.Size() > 1)? positions[positions.Size() - 2] : motion.tail;
+  motion.ticks = snake.GetSubTileTicks();
+  motion.speed = snake.GetSpeed();
+  return motion;
+}
+
+std::unique_lock<std::mutex> Game::LockState() {
+  stateRequested = true;
+  std::unique_lock<std::mutex> lock(stateMutex);
+  stateRequested = false;
+  return lock;
 }
 
-void Game::UpdateState(const Controller::UserCommand command) {
-  // First, process the input user command.
+void Game::CheckPlayerRoundEnd() {
+  // Only applies if snake is being controlled by the player, the game isn't paused, no other question is pending and the 
+  // current round has ended.
+  if (paused || overlay.kind == Overlay::Kind::Confirmation || snake.IsAutoModeOn() || !(victory || !snake.IsAlive())) {
+    return;
+  }
+
+  std::string message;
+  if (victory) {
+    // If the player won the round, display a special congratulating message.
+    // Try to update the record player score.
+    this->maxScorePlayer = std::max(this->maxScorePlayer, this->GetScore());
+
+    // Victory congratulating message.
+    message = "Congratulations for getting past all obstacles and growing to the max, you've completed the game!! :)\n\n";
+
+  } else {
+    // Else if the player collided, check for the score.
+    // If the score is a new record, display a special congratulating message.
+    if (this->GetScore() > this->maxScorePlayer) {
+      // Congratulating message for the new game record.
+      message = "You've set a new record, congratulations!\nPrior player record score: " +
+        std::to_string(this->maxScorePlayer) + "\nNew player record score: " + std::to_string(this->GetScore()) + "\n\n";
+
+      // Update player record score.
+      this->maxScorePlayer = this->GetScore();
+    }
+  }
+
+  // Ask if the player wants to play a new game round ('Yes' as default option).
+  this->ShowConfirmation(message + "Play again?", Game::PendingAction::PlayAgain, true);
+}
+
+void Game::PublishFrame(const Uint64 stepTimestamp, const Uint64 stepPeriod) {
+  World& renderedWorld = (arenaMode)? arena.GetWorld() : world;
+  FrameSnapshot& frame = frames.GetBackBuffer();
+
+  // Copy the rendered world's grid (or, in mosaic mode, the atlas grid holding all of the mosaic games' worlds), along 
+  // with the tiles changed since the previous snapshot.
+  // The whole grid shall be repainted if the rendered grid isn't the one depicted by the previous snapshot.
+  if (mosaicMode) mosaic.UpdateAtlas();
+  const std::vector<World::Element>& grid = (mosaicMode)? mosaic.GetAtlas() : renderedWorld.GetGrid();
+  const std::vector<SDL_Point>& changedTiles = (mosaicMode)? mosaic.GetAtlasChangedTiles() : renderedWorld.GetChangedTiles();
+  frame.sequence = ++frameSequence;
+  frame.fullRedraw = (publishedGrid != &grid);
+  frame.gridSideLen = (mosaicMode)? mosaic.GetAtlasSideLen() : renderedWorld.GetGridSideLen();
+  UpdateFrameGrid(frame.grid, grid, frame.gridSideLen, changedTiles);
+  frame.changedTiles = changedTiles;
+  if (mosaicMode) mosaic.ClearAtlasChangedTiles();
+  else renderedWorld.ClearChangedTiles();
+  publishedGrid = &grid;
+
+  // Copy the motion state of the alive snakes in the rendered world, for their motion to be interpolated (except for the 
+  // mosaic games, whose boards are too small for sub-tile motion to be seen).
+  frame.snakes.clear();
+  if (arenaMode) {
+    for (unsigned int i = 0; i < arena.GetBatchSize(); i++) {
+      if (arena.GetSnake(i).IsAlive()) frame.snakes.push_back(GetSnakeMotion(arena.GetSnake(i)));
+    }
+  } else if (!mosaicMode && snake.IsAlive() && !victory) frame.snakes.push_back(GetSnakeMotion(snake));
+  frame.ticksPerTile = SNAKE_TICKS_PER_TILE;
+  frame.stepTimestamp = stepTimestamp;
+  frame.stepPeriod = stepPeriod;
+
+  // Copy the game information shown to the player.
+  frame.score = (arenaMode)? arena.GetBestScore() : (mosaicMode)? mosaic.GetBestScore() : this->GetScore();
+  frame.maxScorePlayer = this->maxScorePlayer;
+  frame.maxScoreAI = this->maxScoreAI;
+  frame.genCnt = (trainer.IsActive())? trainer.GetGenerationCnt() : snake.GetGenAlgGeneration();
+  frame.indCnt = (trainer.IsActive())? trainer.GetIndividualCnt() : snake.GetGenAlgIndividual();
+  frame.stepsPerSec = this->stepsPerSec;
+  frame.turnCnt = inputLatency.turnCnt;
+  frame.meanInputLatencyMs = (inputLatency.turnCnt > 0)? (unsigned int) (inputLatency.totalMs / inputLatency.turnCnt) : 0;
+  frame.maxInputLatencyMs = inputLatency.maxMs;
+  frame.backgroundTraining = trainer.IsActive();
+  frame.automode = snake.IsAutoModeOn();
+  frame.paused = this->paused;
+  frame.lookahead = snake.IsLookaheadOn();
+  frame.arenaMode = this->arenaMode;
+  frame.mosaicMode = this->mosaicMode;
+  frame.speedMode = !this->fpsCtrlActv;
+  frame.showcaseMode = this->showcaseMode;
+  frame.championReady = this->championReady;
+  frame.championGen = this->champion.generation;
+  frame.championScore = (championReady)? (unsigned int) this->champion.fitness - 1 : 0;
+
+  frames.Publish();
+}
+
+void Game::UpdateFrameGrid(std::vector<World::Element>& copy, const std::vector<World::Element>& grid,
+                           const unsigned int gridSideLen, const std::vector<SDL_Point>& changedTiles) {
+  // Record the changed tiles as stale in every buffer's grid copy, so that each copy is brought up to date the next time
+  // its buffer is written. The copies of another grid, or with more stale tiles than would be worth tracking (the tiles
+  // list taking more memory than the grid itself), are fully copied instead.
+  for (FrameGridState& state : frameGrids) {
+    if (state.fullCopy) continue;
+    if (state.source != &grid || (state.staleTiles.size() + changedTiles.size()) * sizeof(SDL_Point) > grid.size()) {
+      state.fullCopy = true;
+      state.staleTiles.clear();
+    } else state.staleTiles.insert(state.staleTiles.end(), changedTiles.begin(), changedTiles.end());
+  }
+
+  // Then, update the back buffer's copy.
+  FrameGridState& state = frameGrids[frames.GetBackIndex()];
+  if (state.fullCopy || copy.size() != grid.size()) {
+    copy = grid;
+  } else {
+    for (const SDL_Point& tile : state.staleTiles) {
+      const std::size_t cell = (std::size_t) tile.y * gridSideLen + tile.x;
+      copy[cell] = grid[cell];
+    }
+  }
+  state.source = &grid;
+  state.staleTiles.clear();
+  state.fullCopy = false;
+}
+
+void Game::ProcessCommand(const Controller::TimedCommand& timedCommand) {
+  // Process the input user command.
+  const Controller::UserCommand command = timedCommand.command;
   if (command == Controller::UserCommand::Quit) {
     // End the game
     this->running = false;
-  } else if (command == Controller::UserCommand::ToggleFpsCtrl) {
-    // Only enable speed mode switching if snake is in Auto mode.
-    if (snake.IsAutoModeOn()) this->fpsCtrlActv = !fpsCtrlActv;
+    return;
+  }
+
+  // While a question is shown, only the player's answers are processed.
+  if (overlay.kind == Overlay::Kind::Confirmation) {
+    if (command == Controller::UserCommand::AnswerYes) this->ResolveConfirmation(true);
+    else if (command == Controller::UserCommand::AnswerNo) this->ResolveConfirmation(false);
+    else if (command == Controller::UserCommand::AnswerDefault) this->ResolveConfirmation(overlay.yesDefaultOption);
+    return;
+  }
+
+  // Otherwise, any key press dismisses a shown notification. If the game was halted for it, the key has no further effect.
+  // If not (i.e. a timed notification, while the snake keeps moving), the player's turns are still processed, so that no
+  // turn is lost, but any other key only dismisses the notification.
+  if (overlay.kind == Overlay::Kind::Notification) {
+    const bool awaitingPlayer = overlay.IsAwaitingPlayer();
+    this->HideOverlay();
+    if (awaitingPlayer || (command != Controller::UserCommand::GoUp && command != Controller::UserCommand::GoDown
+                           && command != Controller::UserCommand::GoLeft && command != Controller::UserCommand::GoRight)) {
+      return;
+    }
+  }
+  // Answer keys and other keys have no effect outside of a question.
+  if (command == Controller::UserCommand::AnswerYes || command == Controller::UserCommand::AnswerNo 
+      || command == Controller::UserCommand::AnswerDefault || command == Controller::UserCommand::OtherKey) return;
+
+  if (command == Controller::UserCommand::ToggleFpsCtrl) {
+    // Only enable speed mode switching if snake is in Auto mode (the champion replays always run at the regular speed).
+    if (snake.IsAutoModeOn() && !showcaseMode) this->fpsCtrlActv = !fpsCtrlActv;
+  } else if (command == Controller::UserCommand::ToggleLookahead) {
+    // Lookahead search only affects the snake in Auto mode, but can be toggled at any time (except while replaying the
+    // champions, which played with no search).
+    if (!showcaseMode) snake.ToggleLookahead();
+  } else if (command == Controller::UserCommand::ToggleShowcase) {
+    // Only enable showcase mode switching if snake is in Auto mode.
+    if (snake.IsAutoModeOn()) this->SetShowcaseMode(!showcaseMode);
+  } else if (command == Controller::UserCommand::ToggleArenaMode) {
+    // Only enable arena mode switching if snake is in Auto mode (and not showcasing the champions).
+    if (snake.IsAutoModeOn() && !showcaseMode) {
+      this->arenaMode = !arenaMode;
+      this->mosaicMode = false;
+
+      // Start evaluating a batch in the arena, or resume single snake rounds from the genetic algorithm's current individual.
+      if (arenaMode) arena.NewBatch();
+      else this->NewRound();
+    }
+  } else if (command == Controller::UserCommand::ToggleMosaicMode) {
+    // Only enable mosaic mode switching if snake is in Auto mode (and not showcasing the champions).
+    if (snake.IsAutoModeOn() && !showcaseMode) {
+      this->mosaicMode = !mosaicMode;
+      this->arenaMode = false;
+
+      // Start playing a batch of games in the mosaic, or resume single snake rounds from the genetic algorithm's current 
+      // individual.
+      if (mosaicMode) mosaic.NewBatch();
+      else this->NewRound();
+    }
+  } else if (command == Controller::UserCommand::DumpStats) {
+    // Write a snapshot of the instrumentation statistics (only available in instrumentation builds).
+    PROFILE_DUMP(std::cout);
   } else if (command == Controller::UserCommand::Pause) {
     this->paused = !paused;
   } else if (command == Controller::UserCommand::EraseData) {
-    // Display a message box asking for confirmation on the intended action.
-    Game::ConfirmationBoxButtonId selection = this->ShowConfirmationBox(
+    // Ask for confirmation on the intended action.
+    this->ShowConfirmation(
       "Do you really want to proceed with erasing user data?\nPlease note: all game records,"
         " AI learning and current round state will be lost forever, and a new game round will begin.",
-      "Error during display of game's data-erasing confirmation message box."
+      Game::PendingAction::EraseData
     );
 
-    if (selection == Game::ConfirmationBoxButtonId::Yes) {
-      // Restart game data and AI learning.
-      this->ResetData();
-
-      // Display success message in erasing user game data.
-      std::string message = "User data was successfully erased!\nA new game round will now start.";
-      int msgNotOk = SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_INFORMATION, "The Snake Game", message.c_str(), NULL);
-      if (msgNotOk) throw std::runtime_error("Error during display of game's data-erasing success message box.");
-
-    } else {
-      // No user data is erased, and game is resumed.
-      std::string message = "No user data was erased.\nCurrent game round will now be resumed.";
-      int msgNotOk = SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_INFORMATION, "The Snake Game", message.c_str(), NULL);
-      if (msgNotOk) throw std::runtime_error("Error during display of game's data-erasing cancel message box.");
-
-    }
-
   } else if (command == Controller::UserCommand::ToggleAutoMode) {
     // Upon switching from auto to manual mode or vice versa, tell user that game round
     // would be reset and current round data would be lost, and ask for confirmation.
@@ -193,132 +528,175 @@ void Game::UpdateState(const Controller::UserCommand command) {
       question = "If you switch to auto (AI) mode, a new game round will start and current"
         " round data/score will be lost.\nDo you want to proceed?";
     }
-    Game::ConfirmationBoxButtonId selection = this->ShowConfirmationBox(
-      question,
-      "Error during display of game's control mode switching confirmation box."
-    );
+    this->ShowConfirmation(question, Game::PendingAction::ToggleAutoMode);
 
-    if (selection == Game::ConfirmationBoxButtonId::Yes) {
-      // If the user confirms, pass the command to be processed by the snake.
-      snake.ProcessUserCommand(command);
+  } else {
+    // For any other command, just pass the command on to be processed by the snake object.
+    snake.ProcessUserCommand(timedCommand);
+  }
+}
+
+void Game::ResolveConfirmation(const bool confirmed) {
+  const Game::PendingAction action = this->pendingAction;
+  this->pendingAction = Game::PendingAction::None;
+  this->HideOverlay();
+
+  if (action == Game::PendingAction::EraseData) {
+    if (confirmed) {
+      // Restart game data and AI learning.
+      this->ResetData();
+      this->ShowNotification("User data was successfully erased!\nA new game round will now start.");
+    } else {
+      // No user data is erased, and game is resumed.
+      this->ShowNotification("No user data was erased.\nCurrent game round will now be resumed.");
+    }
+
+  } else if (action == Game::PendingAction::ToggleAutoMode) {
+    if (confirmed) {
+      // If the user confirms, pass the command to be processed by the snake. The background training only runs in manual
+      // mode, as the game snake then trains the AI itself. Showcase mode is only available in auto mode.
+      trainer.Pause();
+      if (showcaseMode) {
+        this->showcaseMode = false;
+        if (snake.IsLookaheadOn() != lookaheadBeforeShowcase) snake.ToggleLookahead();
+      }
+      snake.ProcessUserCommand(Controller::TimedCommand{Controller::UserCommand::ToggleAutoMode, SDL_GetTicks()});
 
       // Display mode switch message.
-      std::string message;
-      if (snake.IsAutoModeOn()) message = "Control mode was switched to auto (AI) mode.\nA new game round will now start.";
-      else {
-        message = "Control mode was switched to manual (player) mode.\nA new game round will now start.";
+      if (snake.IsAutoModeOn()) {
+        this->ShowNotification("Control mode was switched to auto (AI) mode.\nA new game round will now start.");
+      } else {
+        this->ShowNotification("Control mode was switched to manual (player) mode.\nA new game round will now start.");
+
+        // Arena and mosaic modes are only available in Auto mode.
+        this->arenaMode = false;
+        this->mosaicMode = false;
         
         // When switching to Manual mode, make sure Speed control is enabled, otherwise game will be unplayable.
         this->fpsCtrlActv = true;
       }
-      int msgNotOk = SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_INFORMATION, "The Snake Game", message.c_str(), NULL);
-      if (msgNotOk) throw std::runtime_error("Error during display of game's control mode switch message box.");
 
       // Reset game round.
       this->NewRound();
+      this->UpdateTraining();
 
     } else {
       // No mode switch, and game is resumed.
-      std::string message;
-      if (snake.IsAutoModeOn()) message = "Control was kept at auto (AI) mode.\nCurrent game round will now be resumed.";
-      else message = "Control was kept at manual (player) mode.\nCurrent game round will now be resumed.";
-      int msgNotOk = SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_INFORMATION, "The Snake Game", message.c_str(), NULL);
-      if (msgNotOk) throw std::runtime_error("Error during display of game's control mode maintainance message box.");
-
+      if (snake.IsAutoModeOn()) {
+        this->ShowNotification("Control was kept at auto (AI) mode.\nCurrent game round will now be resumed.");
+      } else {
+        this->ShowNotification("Control was kept at manual (player) mode.\nCurrent game round will now be resumed.");
+      }
     }
 
-  } else {
-    // For any other command, just pass the command on to be processed by the snake object.
-    snake.ProcessUserCommand(command);
+  } else if (action == Game::PendingAction::PlayAgain) {
+    // Start a new game round, or end the game.
+    if (confirmed) this->NewRound();
+    else this->running = false;
   }
+}
 
-  // Next, update the game state accordingly.
-  // If the snake is deceased or game is paused, no world update needs to be done.
-  if (!snake.IsAlive() || paused) return;
-
-  // Otherwise, move the snake in its current direction.
-  snake.Move();
-
-  // Check if snake head is about to move to a new tile.
-  SDL_Point targetHeadPosition{snake.GetTargetHeadPosition()};
-  SDL_Point headPosition{snake.GetHeadPosition()};
-
-  if (!(targetHeadPosition == headPosition)) {
-    // Checks the new tile content and raises appropriate event (e.g. eating, collision, etc.)
-    if (world.IsObstacle(targetHeadPosition)) {
-      snake.SetEvent(Snake::Event::Killed);
-
-    } else {
-      if (world.GetElement(targetHeadPosition) == World::Element::Food) {
-        snake.SetEvent(Snake::Event::Ate);
+void Game::UpdateState() {
+  PROFILE_SCOPE(UpdateState);
+
+  // In auto mode, in case the current round is over, start a new one first.
+  // In showcase mode, the round is only a replay, which doesn't count for the AI learning: the next one replays the latest
+  // champion (or waits for the first one).
+  if (showcaseMode) {
+    if (!championReady || !snake.IsAlive() || victory) this->NewRound();
+    if (!championReady) return;
+  } else if (snake.IsAutoModeOn() && !arenaMode && !mosaicMode && (!snake.IsAlive() || victory)) {
+    // Try to update the maximum game score, in case a record was achieved.
+    this->maxScoreAI = std::max(this->maxScoreAI, this->GetScore());
+
+    // Update the fitness of the current individual in the Genetic Algorithm population, which then moves 
+    // it to the next individual.
+    // Set the fitness as equal to the snake size/score.
+    // Obs.: this is only done in case the CPU controlled the snake from start to finish of the game, 
+    // otherwise the result doesn't count for the snake AI learning (in case the snake was controlled by 
+    // the player at any point of time).
+    if (eventLog) {
+      eventLog->LogGame(EventLog::Source::Game, snake, snake.GetGenAlgGeneration(), snake.GetGenAlgIndividual());
+    }
+    snake.GradeFitness((float) snake.GetSize());
 
-        // Everytime the snake eats, if in automode, empty the covered grid positions.
-        if (snake.IsAutoModeOn()) coveredPositions.clear();
+    // Reset the game and start a new round.
+    this->NewRound();
+  }
 
-        // Now that the food has been eaten, make new food appear in a free grid tile.
-        if (!world.GrowFood()) {
-          // If a new food cannot be placed, the game has been won.
-          this->victory = true;
-        }
-        
-      } else {
-        // If the snake hasn't collided or eaten, just move it to the new tile.
-        snake.SetEvent(Snake::Event::NewTile);
-
-        // If in automode, the new tile gets looked up for in the covered position+direction container.
-        if (snake.IsAutoModeOn()) {
-          auto searchResult = coveredPositions.find(&world.GetElementRef(targetHeadPosition));
-          if (searchResult != coveredPositions.end()) {
-            // If position is present in the covered positions list, check if direction is also the same as current.
-            if (searchResult->second == snake.GetDirection()) {
-              // If the direction from which the position was entered is the same as current one, kill the snake
-              // and end current game round to prevent an endless game loop.
-              snake.SetEvent(Snake::Event::Killed);
-            } else {
-              // Otherwise, update covered position in container with a new mapped value of current direction.
-              coveredPositions[&world.GetElementRef(targetHeadPosition)] = snake.GetDirection();
-            }
-          } else {
-            // If the position isn't present yet in the container, add it.
-            coveredPositions[&world.GetElementRef(targetHeadPosition)] = snake.GetDirection();
-          }
-        }
-      }
+  // In arena mode, update the arena snakes instead of the game snake, unless the game is paused.
+  if (arenaMode) {
+    // Try to update the maximum AI score before the update, as the arena may start a new batch during it.
+    this->maxScoreAI = std::max(this->maxScoreAI, arena.GetBestScore());
+    arena.Update();
+    return;
+  }
 
-      // If the snake is on automatic mode, call its decision model in order to define the next action/direction.
-      if (snake.IsAutoModeOn()) {
-        snake.DefineAction();
-      }
-    }
+  // Likewise, in mosaic mode, update the mosaic games instead.
+  if (mosaicMode) {
+    this->maxScoreAI = std::max(this->maxScoreAI, mosaic.GetBestScore());
+    mosaic.Update();
+    return;
+  }
 
-  } else {
-    // Snake head is still in the same world grid tile.
-    snake.SetEvent(Snake::Event::SameTile);
+  // If the snake is deceased or the game has been won (while the player is asked whether to play again, in manual mode),
+  // no world update needs to be done.
+  if (!snake.IsAlive() || victory) return;
+
+  // Otherwise, move the snake in its current direction, resolving the content of any new tile it enters
+  // (e.g. eating, collision, etc.).
+  // The lookahead search is given a bounded budget per decision while the frame rate is controlled, and runs unbounded
+  // (limited only by its depth) in speed mode.
+  if (fpsCtrlActv) snake.SetSearchBudget({SNAKE_SEARCH_NODE_BUDGET, SNAKE_SEARCH_TIME_BUDGET_US});
+  else snake.SetSearchBudget({0, 0});
+  snake.Update();
+
+  // If the snake has eaten and the new food couldn't be placed in a free grid tile, the game has been won.
+  if (snake.GetEvent() == Snake::Event::Ate && !world.HasFood()) this->victory = true;
+
+  // Record the snake's action at each new tile (unless replaying a champion), and keep the replay of any new record round.
+  if (!showcaseMode && snake.GetEvent() != Snake::Event::SameTile) {
+    replay.RecordTile(snake, world);
+    if (replay.IsOver()) this->StoreRecordReplay();
   }
 }
 
 void Game::NewRound() {
-  // Reinitialize the world.
-  world.Init();
+  // In showcase mode, replay the latest champion's round, from the same world seed and with the same chromosome. Until
+  // the first champion is available, the previous round is left as is.
+  if (showcaseMode) {
+    this->championReady = trainer.GetChampion(champion);
+    if (!championReady) return;
+    world.Init(champion.seed);
+    snake.Init(champion.chromosome);
+    this->victory = false;
+    return;
+  }
 
-  // Reinitialize the snake.
-  snake.Init();
+  // Reinitialize the world, from a new seed (so that the round can be replayed).
+  const unsigned int seed = (unsigned int) seedGenerator();
+  world.Init(seed);
 
-  // Empty the covered positions container.
-  coveredPositions.clear();
+  // Reinitialize the snake (which also empties its covered positions container), and start recording the round.
+  snake.Init();
+  replay.Start(snake, world, seed);
 
   // Reset the victory state.
   this->victory = false;
 }
 
 void Game::ResetData() {
-  // Restart game data and AI learning.
+  // Restart game data and AI learning, with the background training (if any) paused meanwhile.
+  trainer.Pause();
+
   // Start by deleting "save_state.txt" file, if it exists.
   remove(SAVE_STATE_FILE_PATH);
 
   // Next, reset max player and AI scores.
   this->maxScorePlayer = 0;
   this->maxScoreAI = 0;
+  trainer.ResetMaxScore();
+  trainer.ResetChampion();
 
   // Resets the snake's MLP parameters to the dafault ones.
   snake.ResetMLP();
@@ -326,8 +704,38 @@ void Game::ResetData() {
   // Reset the snake's Genetic Algorithm state, and parameters to the default ones.
   snake.ResetGenAlg();
 
-  // Start a new game round.
+  // Start a new game round (and a new arena or mosaic batch, if in one of those modes).
+  this->NewRound();
+  if (arenaMode) arena.NewBatch();
+  if (mosaicMode) mosaic.NewBatch();
+  this->UpdateTraining();
+}
+
+void Game::SetShowcaseMode(const bool on) {
+  // The replays only use the AI model, like the trainer's workers, so the lookahead search is off meanwhile. Arena and 
+  // speed modes don't apply to the replays either.
+  if (on) {
+    this->lookaheadBeforeShowcase = snake.IsLookaheadOn();
+    if (lookaheadBeforeShowcase) snake.ToggleLookahead();
+    this->arenaMode = false;
+    this->mosaicMode = false;
+    this->fpsCtrlActv = true;
+  } else if (snake.IsLookaheadOn() != lookaheadBeforeShowcase) {
+    snake.ToggleLookahead();
+  }
+
+  // The trainer takes over the genetic algorithm while showcasing (and hands it back to the game snake afterwards).
+  trainer.Pause();
+  this->showcaseMode = on;
+  this->championReady = false;
   this->NewRound();
+  this->UpdateTraining();
+}
+
+void Game::UpdateTraining() {
+  if (showcaseMode) trainer.Resume(false);
+  else if (BACKGROUND_TRAINING && !snake.IsAutoModeOn()) trainer.Resume();
+  else trainer.Pause();
 }
 
 void Game::StoreSaveFile() const {
@@ -349,6 +757,15 @@ void Game::StoreSaveFile() const {
   file.close();
 }
 
+void Game::StoreRecordReplay() const {
+  const unsigned int record = (snake.IsAutoModeOn())? maxScoreAI : maxScorePlayer;
+  if (!REPLAY_RECORDS || replay.GetScore() <= record) return;
+
+  // Each record gets its own file, so the replays make up a history of the records.
+  replay.Store(std::string(REPLAY_FILE_PATH_PREFIX) + ((snake.IsAutoModeOn())? "ai_" : "player_")
+               + std::to_string(replay.GetScore()) + ".replay");
+}
+
 void Game::LoadSaveFile() {
   std::ifstream file(SAVE_STATE_FILE_PATH);
   if (file.is_open()) {
@@ -362,49 +779,41 @@ void Game::LoadSaveFile() {
   file.close();
 }
 
-Game::ConfirmationBoxButtonId Game::ShowConfirmationBox(const std::string& message, const std::string& errMessage,
-    const bool yesDefaultOption) const {
-  SDL_MessageBoxButtonData buttons[] = { 
-    /* .flags, .buttonid, .text */
-    { 0, (int) Game::ConfirmationBoxButtonId::Cancel, "No/Cancel" },
-    { 0, (int) Game::ConfirmationBoxButtonId::Yes, "Yes" }
-  };
+bool Game::IsHalted() const {
+  // The game is halted while paused, or while the player is asked something in manual mode (in auto mode, the AI keeps on 
+  // training meanwhile).
+  return paused || (overlay.IsAwaitingPlayer() && !snake.IsAutoModeOn());
+}
 
-  if (yesDefaultOption) {
-    buttons[1].flags = SDL_MESSAGEBOX_BUTTON_RETURNKEY_DEFAULT | SDL_MESSAGEBOX_BUTTON_ESCAPEKEY_DEFAULT;
-  } else {
-    buttons[0].flags = SDL_MESSAGEBOX_BUTTON_RETURNKEY_DEFAULT | SDL_MESSAGEBOX_BUTTON_ESCAPEKEY_DEFAULT;
+void Game::StopSimulation() {
+  {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    running = false;
   }
+  stateChanged.notify_all();
+  simThread.join();
+}
 
-  const SDL_MessageBoxColorScheme colorScheme = {
-    { /* .colors (.r, .g, .b) */
-      /* [SDL_MESSAGEBOX_COLOR_BACKGROUND] */
-      { 255,   0,   0 },
-      /* [SDL_MESSAGEBOX_COLOR_TEXT] */
-      {   0, 255,   0 },
-      /* [SDL_MESSAGEBOX_COLOR_BUTTON_BORDER] */
-      { 255, 255,   0 },
-      /* [SDL_MESSAGEBOX_COLOR_BUTTON_BACKGROUND] */
-      {   0,   0, 255 },
-      /* [SDL_MESSAGEBOX_COLOR_BUTTON_SELECTED] */
-      { 255,   0, 255 }
-    }
-  };
-
-  const SDL_MessageBoxData confirmationBox = {
-    SDL_MESSAGEBOX_INFORMATION, /* .flags */
-    NULL, /* .window */
-    "The Snake Game", /* .title */
-    message.c_str(), /* .message */
-    SDL_arraysize(buttons), /* .numbuttons */
-    buttons, /* .buttons */
-    &colorScheme /* .colorScheme */
-  };
-
-  int selection = (int) Game::ConfirmationBoxButtonId::None;
-  if (SDL_ShowMessageBox(&confirmationBox, &selection)) {
-    throw std::runtime_error(errMessage);
-  }
+void Game::HideOverlay() {
+  overlay.kind = Overlay::Kind::None;
+  this->overlayRevision++;
+}
+
+void Game::ShowNotification(const std::string& message, const bool awaitPlayer) {
+  this->overlayRevision++;
+  overlay.kind = Overlay::Kind::Notification;
+  overlay.message = message;
+  overlay.yesDefaultOption = false;
+  overlay.shownTimestamp = SDL_GetTicks();
+  overlay.durationMs = (awaitPlayer)? 0 : OVERLAY_NOTIFICATION_MS;
+}
 
-  return (Game::ConfirmationBoxButtonId) selection;
-}
\ No newline at end of file
+void Game::ShowConfirmation(const std::string& message, const Game::PendingAction action, const bool yesDefaultOption) {
+  this->overlayRevision++;
+  overlay.kind = Overlay::Kind::Confirmation;
+  overlay.message = message;
+  overlay.yesDefaultOption = yesDefaultOption;
+  overlay.shownTimestamp = SDL_GetTicks();
+  overlay.durationMs = 0;
+  this->pendingAction = action;
+}
@@ -1,32 +1,90 @@
 #ifndef GAME_H
 #define GAME_H
 
-#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <string>
+#include <memory>
+#include <random>
+#include <array>
 
 #include "controller.h"
 #include "renderer.h"
 #include "world.h"
 #include "snake.h"
+#include "arena.h"
+#include "mosaic.h"
+#include "trainer.h"
 #include "coords2D.h"
+#include "triplebuffer.h"
+#include "framesnapshot.h"
+#include "overlay.h"
+#include "frameencoder.h"
+#include "eventlog.h"
+#include "replay.h"
 
 /**
  *  \brief Class responsible for the arbitration of the game states and mechanics.
  */
 class Game {
  public:
+  /**
+   *  \brief Game run options, e.g. from the command line.
+   */
+  struct Options {
+    /**
+     *  \brief Render with no display (see Renderer), and start right away, with no controls summary to be dismissed.
+     */
+    bool headless{false};
+
+    /**
+     *  \brief Output path the rendered frames are captured to (see FrameEncoder for the formats), or empty for no capture.
+     * While capturing, every frame is rendered (even if paused or hidden), so the video keeps the frame rate.
+     */
+    std::string capturePath;
+
+    /**
+     *  \brief Number of frames after which the capture, and the game, end (or 0 for no limit).
+     */
+    unsigned long captureFrameLimit{0};
+
+    /**
+     *  \brief Start in auto mode, showcasing the trainer's champions.
+     */
+    bool showcase{false};
+
+    /**
+     *  \brief Output path of the event log of the finished AI games (see EventLog for the formats), or empty for no log.
+     */
+    std::string eventLogPath;
+
+    /**
+     *  \brief Output path the statistics of each AI generation are appended to, as CSV (see GenAlg), or empty for none.
+     */
+    std::string statsPath;
+  };
+
   /**
    *  \brief Constructor of Game class object.
    *  \param winWidth Width of the game window, in screen coordinates.
    *  \param winHeight Height of the game window, in screen coordinates.
    *  \param gridSideLen Length of the game grid side, in game coordinates.
+   *  \param options The game run options.
    */
-  Game(const unsigned int winWidth, const unsigned int winHeight, const unsigned int gridSideLen);
+  Game(const unsigned int winWidth, const unsigned int winHeight, const unsigned int gridSideLen, 
+       const Game::Options& options);
 
   /**
    *  \brief Runs the Snake game until it is over.
-   *  \param targetFramePeriod Target game frame period, in milliseconds.
+   * The game simulation runs on its own thread, while the calling (main) thread handles the user input and renders the
+   * latest frame snapshot published by the simulation, at the display frame rate.
+   *  \param targetFrameRate Target game frame rate, in frames per second, used in case the display refresh rate is unknown.
+   *  \param targetStepRate Target simulation step rate (unless in speed mode), in steps per second.
    */
-  void Run(const unsigned int targetFramePeriod);
+  void Run(const unsigned int targetFrameRate, const unsigned int targetStepRate);
 
   /**
    *  \brief Returns the maximum score achieved by the player.
@@ -48,10 +106,74 @@ class Game {
   unsigned int GetScore() const { return (unsigned int) (snake.GetSize() - 1); }
 
   /**
-   *  \brief Process a user command (or no command at all, i.e. UserCommand::None) and updates the game state accordingly.
-   *  \param command Latest command issued by the player.
+   *  \brief Simulation thread routine: updates the game state in fixed timesteps at the target rate (or as fast as possible,
+   * in speed mode), and publishes frame snapshots for the main thread to render, until the game is over.
+   *  \param targetStepRate Target simulation step rate, in steps per second.
+   *  \param frameRate Rate at which frames are rendered, in frames per second.
+   */
+  void Simulate(const unsigned int targetStepRate, const unsigned int frameRate);
+
+  /**
+   *  \brief Indicates if the simulation is halted: paused, or waiting for the player's answer in manual mode.
+   *  \return True, if no game time elapses.
+   */
+  bool IsHalted() const;
+
+  /**
+   *  \brief Ends the game, wakes the simulation thread up (in case it's sleeping while halted), and waits for it to finish.
+   */
+  void StopSimulation();
+
+  /**
+   *  \brief Locks the game state, so that the main thread can read or change it while the simulation thread waits.
+   *  \return The acquired lock of the game state mutex.
+   */
+  std::unique_lock<std::mutex> LockState();
+
+  /**
+   *  \brief Processes a user command (or no command at all, i.e. UserCommand::None). Called by the main thread, with the 
+   * game state locked.
+   *  \param timedCommand Command issued by the player, with its timestamp.
+   */
+  void ProcessCommand(const Controller::TimedCommand& timedCommand);
+
+  /**
+   *  \brief Runs one simulation step, updating the game state (and starting a new round in auto mode, when the current 
+   * one is over). Called by the simulation thread, with the game state locked.
+   */
+  void UpdateState();
+
+  /**
+   *  \brief Checks if the current round was ended by the player in manual mode and, if so, asks if the player wants to 
+   * play again (along with the ending messages). Called by the main thread, with the game state locked.
+   */
+  void CheckPlayerRoundEnd();
+
+  /**
+   *  \brief Copies the rendered world and the game information into a new frame snapshot, and publishes it to the main
+   * thread. Called by the simulation thread, with the game state locked.
+   *  \param stepTimestamp Time of the latest simulation step, as a performance counter value.
+   *  \param stepPeriod Simulation step period, in performance counter ticks (or 0, if not stepping at a steady rate).
+   */
+  void PublishFrame(const Uint64 stepTimestamp, const Uint64 stepPeriod);
+
+  /**
+   *  \brief Brings the grid copy of the back frame snapshot up to date with the rendered grid, only copying the tiles
+   * changed since that snapshot was last written (or the whole grid, if it held another grid, or too many tiles changed).
+   *  \param copy The back snapshot's grid copy.
+   *  \param grid The rendered grid.
+   *  \param gridSideLen The rendered grid's side length.
+   *  \param changedTiles The rendered grid's tiles changed since the previous snapshot.
    */
-  void UpdateState(const Controller::UserCommand command = Controller::UserCommand::None);
+  void UpdateFrameGrid(std::vector<World::Element>& copy, const std::vector<World::Element>& grid,
+                       const unsigned int gridSideLen, const std::vector<SDL_Point>& changedTiles);
+
+  /**
+   *  \brief Returns the motion state of a snake, used to interpolate its rendered head and tail positions.
+   *  \param snake The snake.
+   *  \return The snake's motion state.
+   */
+  static SnakeMotion GetSnakeMotion(const Snake& snake);
 
   /**
    *  \brief Starts a new game round while maintaining game record history and AI learning state.
@@ -64,31 +186,73 @@ class Game {
    */
   void ResetData();
 
+  /**
+   *  \brief Turns the champion showcase mode on or off, starting a new game round.
+   *  \param on True, to replay the trainer's champions while the trainer runs at full speed; false, to go back to the 
+   * regular auto mode rounds.
+   */
+  void SetShowcaseMode(const bool on);
+
+  /**
+   *  \brief Runs or pauses the background training, according to the game mode: unthrottled in showcase mode, throttled in
+   * manual mode (if enabled), and paused otherwise (as the game snake itself then trains the AI).
+   */
+  void UpdateTraining();
+
   /**
    *  \brief Writes the game state to a text file called "save_state.txt" in the game folder, allowing it to be resumed in the next
    * game execution.
    */
   void StoreSaveFile() const;
 
+  /**
+   *  \brief Stores the replay of the current round, which just ended, in a replay file, in case it set a new record score
+   * (of the player or of the AI, depending on the game mode).
+   */
+  void StoreRecordReplay() const;
+
   /**
    *  \brief Tries to load the game state from a text file called "save_state.txt", in the game folder.
    */
   void LoadSaveFile();
 
   /**
-   *  \brief Enumeration for possible ConfirmationBox user inputs.
+   *  \brief Action enum, for the actions taken upon the player's answer to an in-window confirmation:
+   * - None: no confirmation is pending;
+   * - EraseData: erase all game data, if confirmed;
+   * - ToggleAutoMode: switch between manual and auto modes (starting a new round), if confirmed;
+   * - PlayAgain: start a new round in manual mode, if confirmed, or end the game otherwise.
+   */
+  enum class PendingAction { None, EraseData, ToggleAutoMode, PlayAgain };
+
+  /**
+   *  \brief Hides the shown overlay, if any.
+   */
+  void HideOverlay();
+
+  /**
+   *  \brief Shows an informative message over the game grid, replacing any other overlay. The game keeps running.
+   *  \param message String containing the message to be displayed.
+   *  \param awaitPlayer Flag indicating if the message stays until the player presses a key (true), or if it's dismissed
+   * after a while (false).
    */
-  enum class ConfirmationBoxButtonId { None, Yes, Cancel };
+  void ShowNotification(const std::string& message, const bool awaitPlayer = false);
 
   /**
-   *  \brief Opens a pop-up window that interrupts main thread execution and asks for an user input (Yes or Cancel).
+   *  \brief Shows a question over the game grid, replacing any other overlay, to be answered by the player with 'Yes' or 
+   * 'No'. The game keeps running meanwhile (in manual mode, the simulation is held until the answer).
    *  \param message String containing the message/question to be displayed.
-   *  \param errMessage String containing the message to be displayed in case there's an error to SDL lib call.
+   *  \param action Action to be taken upon the player's answer.
    *  \param yesDefaultOption Flag indicating if the 'Yes' button shall be the default option.
-   *  \return Option selected by the user.
    */
-  ConfirmationBoxButtonId ShowConfirmationBox(const std::string& message, 
-    const std::string& errMessage, const bool yesDefaultOption = false) const;
+  void ShowConfirmation(const std::string& message, const PendingAction action, const bool yesDefaultOption = false);
+
+  /**
+   *  \brief Closes the shown confirmation and takes its pending action, according to the player's answer. Called by the
+   * main thread, with the game state locked.
+   *  \param confirmed Flag indicating if the player answered 'Yes'.
+   */
+  void ResolveConfirmation(const bool confirmed);
 
   /**
    *  \brief Controller object, used for reading player inputs.
@@ -105,15 +269,73 @@ class Game {
    */
   World world;
 
+  /**
+   *  \brief The game run options.
+   */
+  const Game::Options options;
+
+  /**
+   *  \brief Encoder of the captured frames (only created while capturing).
+   */
+  std::unique_ptr<FrameEncoder> frameEncoder;
+
+  /**
+   *  \brief Log of the finished AI games (only created if an event log path is set), shared with the arena, the mosaic and
+   * the trainer.
+   */
+  std::unique_ptr<EventLog> eventLog;
+
   /**
    *  \brief Snake object, encapsulating the playable snake state.
    */
   Snake snake;
 
+  /**
+   *  \brief Arena object, where several AI snakes from the same generation share a larger world (used in arena mode).
+   */
+  Arena arena;
+
+  /**
+   *  \brief Mosaic object, where several AI games from the same generation are played at once, each one in its own world 
+   * (used in mosaic mode).
+   */
+  Mosaic mosaic;
+
+  /**
+   *  \brief Trainer object, training the AI in background worker threads while the player controls the snake.
+   */
+  Trainer trainer;
+
+  /**
+   *  \brief Replay recording of the current single snake round (except for champion replays).
+   */
+  Replay replay;
+
+  /**
+   *  \brief Generator of the rounds' world seeds. Initialized in class constructor with the system clock as a seed.
+   */
+  std::default_random_engine seedGenerator;
+
   /**
    *  \brief Flag indicating if the game is still running (true), or is over (false).
    */
-  bool running{false};
+  std::atomic<bool> running{false};
+
+  /**
+   *  \brief Message panel shown over the game grid (changed by the main thread, with the game state locked).
+   */
+  Overlay overlay;
+
+  /**
+   *  \brief Action to be taken upon the player's answer to the shown confirmation.
+   */
+  PendingAction pendingAction{PendingAction::None};
+
+  /**
+   *  \brief Revision number of the overlay, incremented whenever it's shown or hidden (so the main thread knows when the
+   * window shall be redrawn).
+   */
+  unsigned long overlayRevision{0};
 
   /**
    *  \brief Flag indicating if the game has been paused by the player.
@@ -126,6 +348,37 @@ class Game {
    */
   bool fpsCtrlActv{true};
 
+  /**
+   *  \brief Flag indicating if the game is in arena mode (only available in auto mode), where a batch of AI snakes is 
+   * evaluated at once in a shared world, instead of the single game snake.
+   */
+  bool arenaMode{false};
+
+  /**
+   *  \brief Flag indicating if the game is in mosaic mode (only available in auto mode), where a batch of AI games is 
+   * played at once, each one in its own world, and shown side by side instead of the game snake's world.
+   */
+  bool mosaicMode{false};
+
+  /**
+   *  \brief Flag indicating if the game is in champion showcase mode (only available in auto mode), where the trainer's
+   * workers train the AI at full speed, while the game snake only replays the latest champion's game round.
+   */
+  bool showcaseMode{false};
+
+  /**
+   *  \brief The champion replayed by the game snake in showcase mode, and a flag indicating if any was available at the 
+   * round start (otherwise, the round waits for one).
+   */
+  Trainer::Champion champion;
+  bool championReady{false};
+
+  /**
+   *  \brief State of the AI lookahead search before entering showcase mode, restored when leaving it (the replays don't
+   * use the search, like the trainer's workers).
+   */
+  bool lookaheadBeforeShowcase{false};
+
   /**
    *  \brief Maximum game score achieved by the player, after all previous game rounds.
    */
@@ -142,20 +395,84 @@ class Game {
   bool victory{false};
 
   /**
-   *  \brief Snake covered positions container.
-   * This container maps key values of an Element address (representing a position in the game grid
-   * the snake has covered) to a Direction2D representing the direction from which the snake entered
-   * the same grid position.
-   * This is used to identify the beginning of an endless loop of movement during auto (AI) mode, as
-   * the MLP will provide the same output decision for the rest of the game round.
-   * After the snake eats or a new game round starts, this container is emptied.
-   * Then, after every grid position+direction set, this gets added to the container if not there
-   * yet.
-   * Otherwise, if the same position+direction is identified to be present in the map already, the 
-   * snake is killed to end the game round as soon as possible, and thus accelerate the machine 
-   * learning algorithm for the snake AI.
-   */
-  std::unordered_map<World::Element*, Direction2D> coveredPositions;
+   *  \brief The simulation thread.
+   */
+  std::thread simThread;
+
+  /**
+   *  \brief Mutex protecting the game state, which is updated by the simulation thread, and read or changed by the main
+   * thread upon user commands.
+   */
+  std::mutex stateMutex;
+
+  /**
+   *  \brief Indicates that the main thread is waiting for the game state lock, so the simulation thread shall yield it.
+   */
+  std::atomic<bool> stateRequested{false};
+
+  /**
+   *  \brief Condition notified by the main thread whenever the player changes the game state, waking the simulation thread
+   * up while halted.
+   */
+  std::condition_variable stateChanged;
+
+  /**
+   *  \brief Revision number of the game state, incremented by the main thread whenever the player changes it.
+   */
+  unsigned long stateRevision{0};
+
+  /**
+   *  \brief Flag indicating if the game window is hidden (minimized), in which case nothing is rendered.
+   */
+  std::atomic<bool> windowHidden{false};
+
+  /**
+   *  \brief Exception thrown by the simulation thread, if any, to be rethrown by the main thread.
+   */
+  std::exception_ptr simException;
+
+  /**
+   *  \brief Frame snapshots, handed over from the simulation thread to the main thread.
+   */
+  TripleBuffer<FrameSnapshot> frames;
+
+  /**
+   *  \brief Sequence number of the latest published frame snapshot.
+   */
+  unsigned long frameSequence{0};
+
+  /**
+   *  \brief The grid depicted by the latest published frame snapshot, i.e. a world's grid or the mosaic atlas (or null, if
+   * none was published yet).
+   */
+  const std::vector<World::Element> *publishedGrid{nullptr};
+
+  /**
+   *  \brief State of the grid copy held by a frame snapshot buffer: the grid it copies, and the tiles changed since it was
+   * last written (or a flag requesting a full copy, e.g. after the rendered grid changed).
+   */
+  struct FrameGridState {
+    const std::vector<World::Element> *source{nullptr};
+    std::vector<SDL_Point> staleTiles;
+    bool fullCopy{true};
+  };
+
+  /**
+   *  \brief State of the grid copy of each frame snapshot buffer (indexed as in the triple buffer), only accessed by the
+   * simulation thread.
+   */
+  std::array<FrameGridState,3> frameGrids;
+
+  /**
+   *  \brief Number of simulation steps run in the current second, and in the latest complete second.
+   */
+  unsigned int stepCnt{0};
+  unsigned int stepsPerSec{0};
+
+  /**
+   *  \brief Input latency statistics of the player's turns taken in the latest complete second.
+   */
+  Snake::InputLatency inputLatency;
 };
 
 #endif
\ No newline at end of file
@@ -3,7 +3,11 @@
 #include <cmath>
 #include <iostream>
 #include <chrono>
+#include <stdexcept>
 #include "clip.h"
+#include "profiler.h"
+#include "tracer.h"
+#include "allocstats.h"
 
 GenAlg::GenAlg(const unsigned int chromLen, const unsigned int populationSize, 
                 const unsigned int selectionSize, const float mutationFactor)
@@ -34,6 +38,7 @@ void GenAlg::Init() {
 
   // Initialize current individual to first member of the population.
   curIndividual = population.begin();
+  generationStart = std::chrono::steady_clock::now();
 }
 
 void GenAlg::Reset() {
@@ -61,11 +66,19 @@ void GenAlg::GradeCurFitness(const float& fitness) {
 }
 
 void GenAlg::NewGeneration() {
+    PROFILE_SCOPE(NewGeneration);
+    TRACE_SCOPE_ARG("NewGeneration", "generation", generationCnt);
+    ALLOC_RECORD_GENERATION();
+
     // Select the fittest members of the population.
     // Sort the population from most fittest to least.
     std::sort(population.begin(), population.end(), 
         [](const std::pair<VectorXf,float>& a, const std::pair<VectorXf,float>& b) { return a.second > b.second; });
 
+    // Compute the generation statistics from the sorted population, before the least fittest individuals are removed.
+    GenerationStats stats{};
+    if (statsFile.is_open()) ComputeStats(stats);
+
     // Remove the least fittest individuals.
     population.erase(population.begin()+selectionSize, population.end());
 
@@ -77,10 +90,13 @@ void GenAlg::NewGeneration() {
         unsigned int parentA = uniformIntDist(generator);
         unsigned int parentB = uniformIntDist(generator);
         std::pair<VectorXf,float> offspring;
-        offspring.first = std::move(Crossover(population[parentA].first, population[parentB].first));
+        const unsigned long prevMutatedGeneCnt = stats.mutatedGeneCnt;
+        offspring.first = std::move(Crossover(population[parentA].first, population[parentB].first, stats.mutatedGeneCnt));
         offspring.second = 0;
         population.push_back(std::move(offspring));
+        if (stats.mutatedGeneCnt > prevMutatedGeneCnt) stats.mutatedOffspringCnt++;
     }
+    if (statsFile.is_open()) WriteStats(stats);
 
     // Set current individual to first member of new population.
     curIndividual = population.begin();
@@ -88,9 +104,49 @@ void GenAlg::NewGeneration() {
     // Reset the individual count and increment the generation count.
     individualCnt = 0;
     generationCnt = CLPD_UINT_SUM(generationCnt, 1);
+    generationStart = std::chrono::steady_clock::now();
+}
+
+void GenAlg::ComputeStats(GenAlg::GenerationStats& stats) const {
+  // The population is sorted in descending fitness order, so the percentiles are read straight from it, and a single pass
+  // sums the fitness of the whole population and of its survivors.
+  const std::size_t size = population.size();
+  double sum = 0, survivorSum = 0;
+  for (std::size_t i = 0; i < size; i++) {
+    sum += population[i].second;
+    if (i < selectionSize) survivorSum += population[i].second;
+  }
+  auto ascendingAt = [&](const std::size_t idx) { return population[size - 1 - idx].second; };
+
+  stats.generation = generationCnt;
+  stats.minFitness = population.back().second;
+  stats.maxFitness = population.front().second;
+  stats.meanFitness = (float) (sum / size);
+  stats.medianFitness = (size % 2 == 1)? ascendingAt(size / 2) : (ascendingAt(size / 2 - 1) + ascendingAt(size / 2)) / 2;
+  stats.p90Fitness = ascendingAt((std::size_t) std::ceil(0.9 * size) - 1);
+  stats.survivorMeanFitness = (float) (survivorSum / std::min<std::size_t>(selectionSize, size));
+  stats.wallTimeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - generationStart).count();
+}
+
+void GenAlg::WriteStats(const GenAlg::GenerationStats& stats) {
+  statsFile << stats.generation << ',' << stats.minFitness << ',' << stats.meanFitness << ',' << stats.medianFitness << ','
+            << stats.p90Fitness << ',' << stats.maxFitness << ',' << stats.survivorMeanFitness << ','
+            << stats.mutatedGeneCnt << ',' << stats.mutatedOffspringCnt << ',' << stats.wallTimeMs << std::endl;
+}
+
+void GenAlg::SetStatsFile(const std::string& path) {
+  // Only start a new (or empty) file with the header line, so that a resumed training keeps appending to the same table.
+  const bool newFile = std::ifstream(path, std::ios::ate).tellg() <= 0;
+  statsFile.close();
+  statsFile.open(path, std::ios::app);
+  if (!statsFile.is_open()) throw std::runtime_error("Statistics file \"" + path + "\" could not be opened.");
+  if (newFile) {
+    statsFile << "generation,min_fitness,mean_fitness,median_fitness,p90_fitness,max_fitness,survivor_mean_fitness,"
+                 "mutated_genes,mutated_offspring,wall_time_ms" << std::endl;
+  }
 }
 
-VectorXf GenAlg::Crossover(const VectorXf& a, const VectorXf& b) {
+VectorXf GenAlg::Crossover(const VectorXf& a, const VectorXf& b, unsigned long& mutatedGeneCnt) {
     VectorXf result;
     
     // Generates a vector with random elements from a uniform distribution in range [0,1).
@@ -113,6 +169,7 @@ VectorXf GenAlg::Crossover(const VectorXf& a, const VectorXf& b) {
     randomProbVec = (VectorXf::Random(chromLen).array() + (float) 1) / (float) 2;
     // The probability is used to define which chromosome positions shall be offset by the normal mutation operator.
     Eigen::Array<bool,Eigen::Dynamic,1> mutationEnableVec = randomProbVec.array() < mutationFactor;
+    mutatedGeneCnt += (unsigned long) mutationEnableVec.count();
     // Finally, add the mutation offset to the offspring.
     Eigen::ArrayXf mutationOffsetVec = randomOffsetVec.array() * mutationEnableVec.cast<float>();
     result = crossResult + mutationOffsetVec.matrix();
@@ -156,6 +213,7 @@ void GenAlg::LoadState(std::ifstream& file) {
     file >> population[i].second;
   }
 
-  // Restore pointer to current individual being evaluated.
+  // Restore pointer to current individual being evaluated (the generation's wall time only counts from now on).
   curIndividual = population.begin() + individualCnt;
+  generationStart = std::chrono::steady_clock::now();
 }
\ No newline at end of file
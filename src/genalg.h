@@ -5,6 +5,8 @@
 #include <random>
 #include <utility>
 #include <fstream>
+#include <string>
+#include <chrono>
 
 #include <Eigen/Dense>
 
@@ -16,6 +18,23 @@ using Eigen::VectorXf;
  */
 class GenAlg {
  public:
+  /**
+   *  \brief Statistics of a fully evaluated generation: the distribution of its fitness values, the mean fitness of its
+   * survivors, the mutations applied while breeding the next generation's offspring, and the time it took to be evaluated.
+   */
+  struct GenerationStats {
+    unsigned int generation;
+    float minFitness;
+    float meanFitness;
+    float medianFitness;
+    float p90Fitness;
+    float maxFitness;
+    float survivorMeanFitness;
+    unsigned long mutatedGeneCnt;
+    unsigned int mutatedOffspringCnt;
+    double wallTimeMs;
+  };
+
   /**
    *  \brief Constructor of GenAlg class object.
    *  \param chromLen Size of an individual from the population, represented by a numerical chromosome string.
@@ -32,6 +51,22 @@ class GenAlg {
    */
   const VectorXf& GetCurIndividual() const { return curIndividual->first; }
 
+  /**
+   *  \brief Returns an individual/chromosome located after the current one in the population, still pending fitness evaluation.
+   * This allows several individuals to be evaluated at once, before their fitness is graded (in the same order).
+   *  \param offset Position of the individual relative to the current one (0 returns the current individual). Shall be lower
+   * than GetPendingCnt().
+   *  \return The individual/chromosome, as a column vector.
+   */
+  const VectorXf& GetPendingIndividual(const unsigned int offset) const { return (curIndividual + offset)->first; }
+
+  /**
+   *  \brief Returns the number of individuals in the current generation still pending fitness evaluation (including the
+   * current one).
+   *  \return Number of pending individuals.
+   */
+  unsigned int GetPendingCnt() const { return (unsigned int) (population.end() - curIndividual); }
+
   /**
    *  \brief Sets the fitness of the individual/chromosome under current evaluation.
    *  \param fitness Floating-point value representing the fitness that shall be set for the individual.
@@ -67,6 +102,14 @@ class GenAlg {
    */
   void Reset();
 
+  /**
+   *  \brief Starts appending the statistics of each fully evaluated generation to a CSV file (with a header line, if the
+   * file is new or empty), computed along with the natural selection. If the file can't be opened, a runtime exception is
+   * raised.
+   *  \param path The statistics file path.
+   */
+  void SetStatsFile(const std::string& path);
+
  private:
   /**
    *  \brief Re-initializes the genetic algorithm from scratch, re-generating the population and resetting its state.
@@ -79,15 +122,29 @@ class GenAlg {
    */
   void NewGeneration();
 
+  /**
+   *  \brief Computes the statistics of the current generation, once its population is sorted from the fittest individual
+   * to the least fit one.
+   *  \param stats Output parameter set with the fitness and wall time statistics (the mutation counts are left untouched).
+   */
+  void ComputeStats(GenAlg::GenerationStats& stats) const;
+
+  /**
+   *  \brief Appends a generation's statistics to the statistics file.
+   *  \param stats The generation's statistics.
+   */
+  void WriteStats(const GenAlg::GenerationStats& stats);
+
   /**
    *  \brief Performs a random crossover between the two input chromosomes, generating an offspring.
    *  \param a The first parent/crossover operand.
    *  \param b The second parent/crossover operand.
+   *  \param mutatedGeneCnt Output parameter incremented with the number of mutated genes in the offspring.
    *  \return The offspring vector. Each offspring gene is randomly selected between the respective parents genes at the same
    * position. Each gene in the offspring also has a chance that a random offset taken from a normal distribution with mean 0 and
    * stddev of 1 will be applied to it (mutation operand).
    */
-  VectorXf Crossover(const VectorXf& a, const VectorXf& b);
+  VectorXf Crossover(const VectorXf& a, const VectorXf& b, unsigned long& mutatedGeneCnt);
 
   /**
    *  \brief Vector containing all chromosomes in the current generation population. Each element is a pair of a chromosome and its 
@@ -110,6 +167,16 @@ class GenAlg {
    */
   unsigned int individualCnt{0};
 
+  /**
+   *  \brief Time point at which the evaluation of the current generation started (or was resumed, after a state load).
+   */
+  std::chrono::steady_clock::time_point generationStart;
+
+  /**
+   *  \brief File the generations statistics are appended to (only open after SetStatsFile is called).
+   */
+  std::ofstream statsFile;
+
   /**
    *  \brief Length of the chromosomes in the population.
    */
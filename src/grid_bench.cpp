@@ -0,0 +1,72 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <stdexcept>
+
+#include "world.h"
+#include "snake.h"
+
+/**
+ *  File implementing a headless benchmark of the game simulation (i.e. without rendering) for several grid sizes, used to
+ * check that the cost of each game step doesn't depend on the grid area, and that starting a new round stays cheap.
+ */
+
+/**
+ *  \brief Wall time spent simulating each grid size, in seconds.
+ */
+#define BENCH_DURATION_S 2.0
+
+/**
+ *  \brief Simulates AI-controlled rounds in a world of the given size for a fixed wall time, and prints the step throughput
+ * and the average round setup time.
+ *  \param gridSideLen The square world grid's width/height, in number of grid cells.
+ */
+void RunBenchmark(const unsigned int gridSideLen) {
+  using Clock = std::chrono::steady_clock;
+
+  // Construction (i.e. the only full grid initialization) is not part of the measurements.
+  World world(gridSideLen);
+  Snake snake(SDL_Point{(int) gridSideLen / 2, (int) gridSideLen / 2}, world);
+  snake.SetAutoMode(true);
+
+  unsigned long long steps = 0;
+  unsigned long long rounds = 0;
+  double setupTimeS = 0;
+  const Clock::time_point start = Clock::now();
+  while (std::chrono::duration<double>(Clock::now() - start).count() < BENCH_DURATION_S) {
+    // Run a batch of game steps between time checks.
+    for (int i = 0; i < 1000; i++) {
+      snake.Update();
+      steps++;
+
+      if (!snake.IsAlive() || !world.HasFood()) {
+        // Grade the individual and start a new round, as done by the game in auto mode.
+        snake.GradeFitness((float) snake.GetSize());
+        const Clock::time_point setupStart = Clock::now();
+        world.Init();
+        snake.Init();
+        setupTimeS += std::chrono::duration<double>(Clock::now() - setupStart).count();
+        rounds++;
+      }
+    }
+  }
+  const double elapsedS = std::chrono::duration<double>(Clock::now() - start).count();
+
+  std::cout << std::setw(6) << gridSideLen << " | "
+            << std::setw(12) << std::fixed << std::setprecision(0) << steps / elapsedS << " | "
+            << std::setw(8) << rounds << " | "
+            << std::setw(14) << std::setprecision(2) << ((rounds > 0)? 1e6 * setupTimeS / rounds : 0.0) << std::endl;
+}
+
+int main() {
+  try {
+    std::cout << " Grid  |  Steps/sec   |  Rounds  | Setup/round (us)" << std::endl;
+    for (const unsigned int gridSideLen : std::vector<unsigned int>{31, 128, 512, 1024}) RunBenchmark(gridSideLen);
+  } catch(const std::exception& e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return -1;
+  }
+
+  return 0;
+}
@@ -1,36 +1,109 @@
 #include <iostream>
 #include <stdexcept>
+#include <string>
+#include <algorithm>
 
 #include "game.h"
 #include "config.h"
+#include "tracer.h"
 
 #include "SDL.h"
 
+/**
+ *  \brief Parses an unsigned integer command line argument value.
+ *  \param arg The argument value.
+ *  \param value Output parameter set with the parsed value.
+ *  \return True, if the whole argument is an unsigned integer; false, otherwise.
+ */
+static bool ParseUnsigned(const std::string& arg, unsigned long& value) {
+  std::size_t parsedLen = 0;
+  try { value = std::stoul(arg, &parsedLen); } catch(const std::exception&) { parsedLen = 0; }
+  return parsedLen > 0 && parsedLen == arg.size() && arg[0] != '-';
+}
+
 int main(int argc, char **argv) {
+  Game::Options options;
   try {
-    std::string message = "The Snake Game will begin!\n"
-      "Please find the game controls summary below:\n"
-      "- Arrow keys: controls the snake in Manual mode (i.e. player in control);\n"
-      "- 'A' key: toggles Auto mode (i.e. AI in control) on and off;\n"
-      "- 'S' key: toggles Speed mode (i.e. no frame rate control) on and off (obs.: only available in Auto mode);\n"
-      "- 'P' key: pauses the game (or resumes it);\n"
-      "- 'E' key: erases and resets all game data, inclusing record scores and AI learning;\n"
-      "- Close game window: ends the game and exit.";
-    int msgNotOk = SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_INFORMATION, "The Snake Game", message.c_str(), NULL);
-    if (msgNotOk) throw std::runtime_error("Error during display of game's starting message box.");
-
-    Game game(WINDOW_WIDTH, WINDOW_HEIGHT, GRID_SIDE_LENGTH);
-    game.Run(FRAME_PERIOD_MS);
-
-    message = "Game has terminated successfully!\n"
+    // The grid side length may optionally be passed as a command line argument (e.g. "./SnakeGame 1000"), along with the
+    // following options:
+    // - "--headless": renders with no display (e.g. with SDL's dummy video driver), along with "--showcase" or "--frames";
+    // - "--capture <path>": captures the rendered frames to a video file or pipe (e.g. "champion.y4m", or "-");
+    // - "--frames <count>": ends the game after capturing the given number of frames (along with "--capture");
+    // - "--showcase": starts in auto mode, showcasing the AI champions;
+    // - "--event-log <path>": logs every finished AI game to a JSON lines file (or CSV, for paths ending in ".csv");
+    // - "--stats <path>": appends the fitness statistics of every AI generation to a CSV file;
+    // - "--trace <path>": records a Chrome trace-event timeline of the frames, workers and generations (only available in
+    //   instrumentation builds).
+    unsigned long gridSideLen = GRID_SIDE_LENGTH;
+    std::string tracePath;
+    for (int i = 1; i < argc; i++) {
+      const std::string arg{argv[i]};
+      if (arg == "--headless") {
+        options.headless = true;
+      } else if (arg == "--showcase") {
+        options.showcase = true;
+      } else if (arg == "--capture" && i + 1 < argc) {
+        options.capturePath = argv[++i];
+      } else if (arg == "--event-log" && i + 1 < argc) {
+        options.eventLogPath = argv[++i];
+      } else if (arg == "--stats" && i + 1 < argc) {
+        options.statsPath = argv[++i];
+      } else if (arg == "--trace" && i + 1 < argc) {
+        tracePath = argv[++i];
+      } else if (arg == "--frames" && i + 1 < argc) {
+        const std::string value{argv[++i]};
+        if (!ParseUnsigned(value, options.captureFrameLimit)) {
+          throw std::runtime_error("Invalid frame count \"" + value + "\" (expected an unsigned integer).");
+        }
+      } else if (!ParseUnsigned(arg, gridSideLen) || gridSideLen < GRID_MIN_SIDE_LENGTH || gridSideLen > GRID_MAX_SIDE_LENGTH) {
+        throw std::runtime_error("Invalid grid side length \"" + arg + "\" (expected an integer from " 
+                                  + std::to_string(GRID_MIN_SIDE_LENGTH) + " to " + std::to_string(GRID_MAX_SIDE_LENGTH) + ").");
+      }
+    }
+    // The frame count limits the captured frames, so it's only meaningful along with a capture.
+    if (options.captureFrameLimit > 0 && options.capturePath.empty()) {
+      throw std::runtime_error("The \"--frames\" option requires \"--capture <path>\".");
+    }
+    // With no display, nobody can answer the game's prompts (e.g. "Play again?"), so a headless game must either play by
+    // itself or end by itself.
+    if (options.headless && !options.showcase && options.captureFrameLimit == 0) {
+      throw std::runtime_error("The \"--headless\" option requires \"--showcase\" or \"--frames <count>\".");
+    }
+
+    // Keep the window close to its standard size, with an integer number of pixels (at least one) per grid cell.
+    const unsigned int cellSize = std::max<unsigned int>(1, WINDOW_WIDTH / gridSideLen);
+    const unsigned int winWidth = cellSize * gridSideLen;
+    const unsigned int winHeight = winWidth * WINDOW_HEIGHT / WINDOW_WIDTH;
+
+    // Start tracing before the game starts its threads, so that they're all traced.
+    if (!tracePath.empty()) {
+#ifdef SNAKE_INSTRUMENTATION
+      TRACE_START(tracePath);
+      TRACE_THREAD_NAME("main");
+#else
+      throw std::runtime_error("Tracing is only available in instrumentation builds (see SNAKE_INSTRUMENTATION).");
+#endif
+    }
+
+    Game game(winWidth, winHeight, gridSideLen, options);
+    game.Run(FRAME_RATE_FPS, SIM_STEP_RATE);
+    TRACE_STOP();
+
+    std::string message = "Game has terminated successfully!\n"
       "Player Max Score: " + std::to_string(game.GetMaxScorePlayer()) + "\n"
       "AI Max Score: " + std::to_string(game.GetMaxScoreAI()) + "\n";
-    msgNotOk = SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_INFORMATION, "The Snake Game", message.c_str(), NULL);
-    if (msgNotOk) throw std::runtime_error("Error during display of game's ending message box.");
+    if (options.headless) {
+      // With no display, the ending message goes to the error stream (as the standard output may hold the captured video).
+      std::cerr << message;
+    } else {
+      int msgNotOk = SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_INFORMATION, "The Snake Game", message.c_str(), NULL);
+      if (msgNotOk) throw std::runtime_error("Error during display of game's ending message box.");
+    }
 
   } catch(const std::exception& e) {
+    TRACE_STOP();
     std::string message{"An error occurred. Please try restarting the game.\nError: " + std::string(e.what())};
-    int msgNotOk = SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "The Snake Game", message.c_str(), NULL);
+    int msgNotOk = (options.headless)? 1 : SDL_ShowSimpleMessageBox(SDL_MESSAGEBOX_ERROR, "The Snake Game", message.c_str(), NULL);
     if (msgNotOk) {
       // In case message box returned non-zero error code, output exception message to error stream.
       std::cerr << "An error occurred. Please try restarting the game.\nError: " << e.what() << std::endl;
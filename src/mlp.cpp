@@ -1,5 +1,6 @@
 #include "mlp.h"
 #include <stdexcept>
+#include "profiler.h"
 
 MLP::MLP(const unsigned int inputSize, const std::vector<unsigned int>& layerSizes) : 
         inputSize{inputSize}, defLayerSizes{layerSizes}, layerSizes{layerSizes}  {
@@ -39,6 +40,8 @@ void MLP::Reset() {
 }
 
 VectorXf MLP::GetOutput(VectorXf input) {
+    PROFILE_SCOPE(MlpOutput);
+
     // Protect against the possibility of the function argument not having the correct size.
     // Its size should be equal to the total number of MLP inputs.
     if (input.size() != inputSize) {
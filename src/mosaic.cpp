@@ -0,0 +1,92 @@
+#include "mosaic.h"
+#include <cmath>
+#include <algorithm>
+
+Mosaic::Mosaic(const unsigned int gameCnt, const unsigned int gridSideLen, std::shared_ptr<GenAlg> genalg,
+               EventLog *eventLog)
+  : genalg(genalg),
+    eventLog(eventLog),
+    gridSideLen(gridSideLen) {
+  // Each game has its own world and snake, with the snake starting at the world center.
+  const unsigned int cnt = std::max(gameCnt, (unsigned int) 1);
+  for (unsigned int i = 0; i < cnt; i++) {
+    worlds.push_back(std::make_unique<World>(gridSideLen));
+    snakes.push_back(std::make_unique<Snake>(SDL_Point{(int) gridSideLen/2, (int) gridSideLen/2}, *worlds.back(), genalg));
+    snakes.back()->SetAutoMode(true);
+  }
+
+  // Lay the game boards out in rows and columns, as close to a square as possible, with a one tile gap between them.
+  columns = (unsigned int) std::ceil(std::sqrt((float) cnt));
+  atlasSideLen = columns * (gridSideLen + 1) - 1;
+  atlas.assign((std::size_t) atlasSideLen * atlasSideLen, World::Element::None);
+  atlasChangedFlags.assign(atlas.size(), false);
+}
+
+void Mosaic::NewBatch() {
+  // Take the next individuals pending evaluation, one per game, each one starting a round in its reinitialized world.
+  // Obs.: the worlds left with no game at the end of a generation are reinitialized as well, to clear their boards.
+  batchSize = std::min((unsigned int) snakes.size(), genalg->GetPendingCnt());
+  for (unsigned int i = 0; i < snakes.size(); i++) {
+    worlds[i]->Init();
+    if (i < batchSize) snakes[i]->Init(genalg->GetPendingIndividual(i));
+  }
+}
+
+void Mosaic::Update() {
+  bool anyPlaying = false;
+  for (unsigned int i = 0; i < batchSize; i++) {
+    if (IsGameOver(i)) continue;
+
+    snakes[i]->Update();
+    if (!IsGameOver(i)) anyPlaying = true;
+  }
+
+  if (!anyPlaying) {
+    GradeBatch();
+    NewBatch();
+  }
+}
+
+void Mosaic::UpdateAtlas() {
+  for (unsigned int i = 0; i < worlds.size(); i++) {
+    // Board origin in the atlas.
+    const int originX = (int) ((i % columns) * (gridSideLen + 1));
+    const int originY = (int) ((i / columns) * (gridSideLen + 1));
+
+    // Copy the changed tiles. Boards with no game in the current batch only show their walls.
+    const std::vector<World::Element>& grid = worlds[i]->GetGrid();
+    for (const SDL_Point& tile : worlds[i]->GetChangedTiles()) {
+      const SDL_Point atlasTile{originX + tile.x, originY + tile.y};
+      const std::size_t cell = (std::size_t) atlasTile.y * atlasSideLen + atlasTile.x;
+      const World::Element element = grid[(std::size_t) tile.y * gridSideLen + tile.x];
+      atlas[cell] = (i < batchSize || element == World::Element::Wall)? element : World::Element::None;
+      if (!atlasChangedFlags[cell]) {
+        atlasChangedFlags[cell] = true;
+        atlasChangedTiles.push_back(atlasTile);
+      }
+    }
+    worlds[i]->ClearChangedTiles();
+  }
+}
+
+void Mosaic::ClearAtlasChangedTiles() {
+  for (const SDL_Point& tile : atlasChangedTiles) atlasChangedFlags[(std::size_t) tile.y * atlasSideLen + tile.x] = false;
+  atlasChangedTiles.clear();
+}
+
+unsigned int Mosaic::GetBestScore() const {
+  int bestSize = 1;
+  for (unsigned int i = 0; i < batchSize; i++) bestSize = std::max(bestSize, snakes[i]->GetSize());
+  return (unsigned int) (bestSize - 1);
+}
+
+void Mosaic::GradeBatch() {
+  // Set each individual fitness as equal to its snake size, as done for single snake rounds.
+  // Obs.: the genetic algorithm's current individual is always the first one of the batch.
+  for (unsigned int i = 0; i < batchSize; i++) {
+    if (eventLog != nullptr) {
+      eventLog->LogGame(EventLog::Source::Mosaic, *snakes[i], genalg->GetGenerationCnt(), genalg->GetIndividualCnt());
+    }
+    genalg->GradeCurFitness((float) snakes[i]->GetSize());
+  }
+}
@@ -0,0 +1,144 @@
+#ifndef MOSAIC_H
+#define MOSAIC_H
+
+#include <vector>
+#include <memory>
+
+#include "world.h"
+#include "snake.h"
+#include "genalg.h"
+#include "eventlog.h"
+
+/**
+ *  \brief Class managing a batch of separate AI games, one per individual from the same genetic algorithm generation, laid
+ * out side by side as the tiles of a mosaic. Unlike the arena, each snake plays in its own small world, as in a regular
+ * round. The game grids are copied into one atlas grid (with a one tile gap between boards), so that the whole batch is
+ * rendered at once, as a single world.
+ */
+class Mosaic {
+ public:
+  /**
+   *  \brief Constructor of the Mosaic class object.
+   *  \param gameCnt Maximum number of games (i.e. individuals) played at once.
+   *  \param gridSideLen The side length of each game's square world, in number of grid cells.
+   *  \param genalg The genetic algorithm whose individuals are evaluated.
+   *  \param eventLog Log of the finished games (or nullptr, for no logging).
+   */
+  Mosaic(const unsigned int gameCnt, const unsigned int gridSideLen, std::shared_ptr<GenAlg> genalg,
+         EventLog *eventLog = nullptr);
+
+  /**
+   *  \brief Re-initializes the games' worlds and starts the evaluation of a new batch, made of the next individuals pending
+   * evaluation in the genetic algorithm.
+   */
+  void NewBatch();
+
+  /**
+   *  \brief Updates the snakes of the batch whose game is not over yet. Once all games are over, grades the fitness of the
+   * batch individuals and starts a new batch.
+   */
+  void Update();
+
+  /**
+   *  \brief Copies the grid tiles changed in the games' worlds since the previous call into the atlas grid.
+   */
+  void UpdateAtlas();
+
+  /**
+   *  \brief Returns the atlas grid, holding every game's world grid, e.g. for rendering.
+   *  \return Const reference to the atlas elements, in row-major order (i.e. position (x,y) at index y * atlasSideLen + x).
+   */
+  const std::vector<World::Element>& GetAtlas() const { return atlas; }
+
+  /**
+   *  \brief Returns the length of the atlas grid side.
+   *  \return The square atlas width/height, in number of grid cells.
+   */
+  unsigned int GetAtlasSideLen() const { return atlasSideLen; }
+
+  /**
+   *  \brief Returns the atlas tiles changed since the change list was last cleared (each one listed once).
+   *  \return Const reference to the list of changed tile positions, in atlas coordinates.
+   */
+  const std::vector<SDL_Point>& GetAtlasChangedTiles() const { return atlasChangedTiles; }
+
+  /**
+   *  \brief Empties the list of changed atlas tiles, e.g. after they have been redrawn.
+   */
+  void ClearAtlasChangedTiles();
+
+  /**
+   *  \brief Returns the number of games in the current batch.
+   *  \return Number of games (i.e. individuals) being evaluated.
+   */
+  unsigned int GetBatchSize() const { return batchSize; }
+
+  /**
+   *  \brief Returns the highest score achieved among the games of the current batch.
+   *  \return The highest score, in points.
+   */
+  unsigned int GetBestScore() const;
+
+ private:
+  /**
+   *  \brief Indicates if a game of the current batch is over, i.e. if its snake died or filled its whole world.
+   *  \param idx Index of the game.
+   *  \return True, if the game is over; false, otherwise.
+   */
+  bool IsGameOver(const unsigned int idx) const { return !snakes[idx]->IsAlive() || !worlds[idx]->HasFood(); }
+
+  /**
+   *  \brief Grades the fitness of each individual in the current batch, in the same order they were taken from the genetic
+   * algorithm.
+   */
+  void GradeBatch();
+
+  /**
+   *  \brief The genetic algorithm whose individuals are evaluated.
+   */
+  std::shared_ptr<GenAlg> genalg;
+
+  /**
+   *  \brief Log of the finished games (or nullptr, for no logging).
+   */
+  EventLog *eventLog;
+
+  /**
+   *  \brief Worlds and snakes of the games, one of each per game.
+   */
+  std::vector<std::unique_ptr<World>> worlds;
+  std::vector<std::unique_ptr<Snake>> snakes;
+
+  /**
+   *  \brief Number of individuals in the current batch (may be smaller than the number of games at the end of a generation).
+   */
+  unsigned int batchSize{0};
+
+  /**
+   *  \brief Side length of each game's world, and number of game boards per atlas row.
+   */
+  const unsigned int gridSideLen;
+  unsigned int columns;
+
+  /**
+   *  \brief The atlas grid, holding every game's world grid at its board position (and empty gaps between boards).
+   */
+  std::vector<World::Element> atlas;
+
+  /**
+   *  \brief The side length of the atlas grid.
+   */
+  unsigned int atlasSideLen;
+
+  /**
+   *  \brief Positions of the atlas tiles changed since the change list was last cleared.
+   */
+  std::vector<SDL_Point> atlasChangedTiles;
+
+  /**
+   *  \brief Flags indicating which atlas cells are already listed in atlasChangedTiles, so that each one is listed only once.
+   */
+  std::vector<bool> atlasChangedFlags;
+};
+
+#endif
@@ -0,0 +1,118 @@
+#ifndef MPSCQUEUE_H
+#define MPSCQUEUE_H
+
+#include <vector>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ *  \brief Bounded lock-free queue, used to hand values over from any number of writer threads to a single reader thread.
+ * Each slot has a sequence number telling whether it's free for the writer claiming its position, or holds a value ready
+ * for the reader, so neither side ever waits for the other: writers claim positions with a compare-and-swap, and a push to
+ * a full queue fails instead of blocking. The capacity is rounded up to a power of two, and all the storage is allocated
+ * at construction.
+ */
+template<typename T>
+class MpscQueue {
+ public:
+  /**
+   *  \brief Constructor of the queue.
+   *  \param minCapacity Minimum number of values the queue shall be able to hold. The actual capacity is the smallest power
+   * of two greater than or equal to it.
+   */
+  MpscQueue(const std::size_t minCapacity) : slots(RoundUpPow2(minCapacity)), mask(slots.size() - 1) {
+    for (std::size_t i = 0; i < slots.size(); i++) slots[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  /**
+   *  \brief Appends a value to the queue (any writer thread).
+   *  \param value The value.
+   *  \return True, if the value was queued; false, if the queue was full (in which case the value is dropped).
+   */
+  bool Push(const T& value) {
+    std::size_t pos = writePos.load(std::memory_order_relaxed);
+    Slot *slot;
+    while (true) {
+      slot = &slots[pos & mask];
+      const std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+      const intptr_t diff = (intptr_t) sequence - (intptr_t) pos;
+      if (diff == 0) {
+        // The slot is free for this position: claim it, unless another writer did first.
+        if (writePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+      } else if (diff < 0) {
+        // The slot still holds the value written one lap before, not read yet: the queue is full.
+        return false;
+      } else {
+        // Another writer claimed the position meanwhile.
+        pos = writePos.load(std::memory_order_relaxed);
+      }
+    }
+
+    // Write the value, then hand the slot over to the reader.
+    slot->value = value;
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   *  \brief Takes the oldest value from the queue (reader thread only).
+   *  \param value Output parameter set with the value.
+   *  \return True, if a value was taken; false, if the queue is empty (or its oldest value isn't fully written yet).
+   */
+  bool Pop(T& value) {
+    Slot& slot = slots[readPos & mask];
+    if (slot.sequence.load(std::memory_order_acquire) != readPos + 1) return false;
+
+    // Read the value, then hand the slot back to the writers, for the position one lap ahead.
+    value = slot.value;
+    slot.sequence.store(readPos + slots.size(), std::memory_order_release);
+    readPos++;
+    return true;
+  }
+
+  /**
+   *  \brief Returns the maximum number of values the queue can hold.
+   *  \return Queue capacity.
+   */
+  std::size_t Capacity() const { return slots.size(); }
+
+ private:
+  /**
+   *  \brief Slot of the queue, holding a value and its sequence number: equal to the slot's position while it's free for a
+   * writer, and to the position plus one once it holds a value to be read.
+   */
+  struct Slot {
+    std::atomic<std::size_t> sequence{0};
+    T value{};
+  };
+
+  /**
+   *  \brief Returns the smallest power of two greater than or equal to the input value (and at least 1).
+   *  \param value The input value.
+   *  \return The power of two.
+   */
+  static std::size_t RoundUpPow2(const std::size_t value) {
+    std::size_t result = 1;
+    while (result < value) result <<= 1;
+    return result;
+  }
+
+  /**
+   *  \brief The queue slots, and the mask wrapping a position around the slots (i.e. the capacity minus one).
+   */
+  std::vector<Slot> slots;
+  const std::size_t mask;
+
+  /**
+   *  \brief Next position to be claimed by a writer, in its own cache line, as it's contended by the writers.
+   */
+  alignas(64) std::atomic<std::size_t> writePos{0};
+
+  /**
+   *  \brief Next position to be read (only accessed by the reader thread), in its own cache line.
+   */
+  alignas(64) std::size_t readPos{0};
+};
+
+#endif
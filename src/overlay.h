@@ -0,0 +1,54 @@
+#ifndef OVERLAY_H
+#define OVERLAY_H
+
+#include <string>
+
+#include "SDL.h"
+
+/**
+ *  \brief Message panel drawn over the game grid, inside the game window, in place of a modal message box. The game loop
+ * keeps running while it's shown: notifications go away after a while (or upon any key press), and confirmations wait for
+ * the player's answer, which is received as a regular user command.
+ */
+struct Overlay {
+  /**
+   *  \brief Overlay kind enum:
+   * - None: no overlay is shown;
+   * - Notification: informative message, dismissed after its duration, or upon any key press;
+   * - Confirmation: question answered with 'Y' (yes) or 'N' (no) keys, or with Enter/Escape keys (default option).
+   */
+  enum class Kind { None, Notification, Confirmation };
+
+  /**
+   *  \brief The overlay kind.
+   */
+  Kind kind{Kind::None};
+
+  /**
+   *  \brief The message shown, where '\n' characters start new lines (longer lines are wrapped to the panel width).
+   */
+  std::string message;
+
+  /**
+   *  \brief Flag indicating if 'Yes' is the default option of a confirmation (or 'No', otherwise).
+   */
+  bool yesDefaultOption{false};
+
+  /**
+   *  \brief Time the overlay was shown, in milliseconds since SDL initialization.
+   */
+  Uint32 shownTimestamp{0};
+
+  /**
+   *  \brief Time a notification stays shown, in milliseconds, or 0 if it's only dismissed upon a key press.
+   */
+  Uint32 durationMs{0};
+
+  /**
+   *  \brief Indicates if the overlay waits for the player (i.e. a confirmation, or a notification with no duration).
+   *  \return True, if the overlay is only dismissed by the player.
+   */
+  bool IsAwaitingPlayer() const { return kind == Kind::Confirmation || (kind == Kind::Notification && durationMs == 0); }
+};
+
+#endif
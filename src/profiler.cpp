@@ -0,0 +1,118 @@
+#include "profiler.h"
+#include "allocstats.h"
+
+#ifdef SNAKE_INSTRUMENTATION
+
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+
+std::atomic<Profiler::ThreadStats*> Profiler::threadStatsHead{nullptr};
+
+unsigned int Profiler::GetBucket(const uint64_t valueNs) {
+  // Values below 2^SUB_BUCKET_BITS get a bucket each. Any other value is located by its highest set bit (its power of two
+  // range) and the SUB_BUCKET_BITS bits right below it (its linear sub-bucket in the range).
+  if (valueNs < (1u << SUB_BUCKET_BITS)) return (unsigned int) valueNs;
+  unsigned int exponent = 63;
+  while (!(valueNs >> exponent)) exponent--;
+  const unsigned int subBucket = (unsigned int) (valueNs >> (exponent - SUB_BUCKET_BITS)) & ((1u << SUB_BUCKET_BITS) - 1);
+  const unsigned int bucket = ((exponent - SUB_BUCKET_BITS + 1) << SUB_BUCKET_BITS) + subBucket;
+  return (bucket < BUCKET_CNT)? bucket : BUCKET_CNT - 1;
+}
+
+uint64_t Profiler::GetBucketValue(const unsigned int bucket) {
+  if (bucket < (1u << SUB_BUCKET_BITS)) return bucket;
+  const unsigned int exponent = (bucket >> SUB_BUCKET_BITS) + SUB_BUCKET_BITS - 1;
+  const uint64_t subBucket = bucket & ((1u << SUB_BUCKET_BITS) - 1);
+  return ((uint64_t) (1u << SUB_BUCKET_BITS) + subBucket) << (exponent - SUB_BUCKET_BITS);
+}
+
+Profiler::ThreadStats& Profiler::GetThreadStats() {
+  thread_local ThreadStats *stats = nullptr;
+  if (stats == nullptr) {
+    // Value-initialize the statistics (zeroing the counters), and push them to the head of the list.
+    stats = new ThreadStats();
+    stats->next = threadStatsHead.load(std::memory_order_relaxed);
+    while (!threadStatsHead.compare_exchange_weak(stats->next, stats, std::memory_order_release,
+                                                  std::memory_order_relaxed)) {}
+  }
+  return *stats;
+}
+
+void Profiler::Record(const Profiler::Probe probe, const uint64_t durationNs) {
+  // Only the owner thread writes its statistics, so plain loads and stores are enough (the atomics only keep the snapshot
+  // reads well-defined).
+  ThreadStats& stats = GetThreadStats();
+  const unsigned int idx = (unsigned int) probe;
+  std::atomic<uint64_t>& bucket = stats.buckets[idx][GetBucket(durationNs)];
+  bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  stats.callCnt[idx].store(stats.callCnt[idx].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  stats.totalNs[idx].store(stats.totalNs[idx].load(std::memory_order_relaxed) + durationNs, std::memory_order_relaxed);
+  if (durationNs > stats.maxNs[idx].load(std::memory_order_relaxed)) {
+    stats.maxNs[idx].store(durationNs, std::memory_order_relaxed);
+  }
+}
+
+void Profiler::Dump(std::ostream& stream) {
+  // Sum up the statistics of all threads, per probe.
+  const unsigned int probeCnt = (unsigned int) Probe::Count;
+  std::vector<uint64_t> callCnt(probeCnt, 0), totalNs(probeCnt, 0), maxNs(probeCnt, 0);
+  std::vector<std::vector<uint64_t>> buckets(probeCnt, std::vector<uint64_t>(BUCKET_CNT, 0));
+  unsigned int threadCnt = 0;
+  for (ThreadStats *stats = threadStatsHead.load(std::memory_order_acquire); stats != nullptr; stats = stats->next) {
+    threadCnt++;
+    for (unsigned int i = 0; i < probeCnt; i++) {
+      callCnt[i] += stats->callCnt[i].load(std::memory_order_relaxed);
+      totalNs[i] += stats->totalNs[i].load(std::memory_order_relaxed);
+      maxNs[i] = std::max<uint64_t>(maxNs[i], stats->maxNs[i].load(std::memory_order_relaxed));
+      for (unsigned int j = 0; j < BUCKET_CNT; j++) buckets[i][j] += stats->buckets[i][j].load(std::memory_order_relaxed);
+    }
+  }
+
+  // Percentiles are taken as the lowest value of the bucket holding the rank (as the buckets are read while the threads
+  // keep recording, their sum may slightly differ from the call count).
+  auto percentileUs = [&](const unsigned int probe, const double fraction) {
+    uint64_t total = 0;
+    for (const uint64_t cnt : buckets[probe]) total += cnt;
+    const uint64_t rank = (uint64_t) (fraction * total);
+    uint64_t seen = 0;
+    for (unsigned int j = 0; j < BUCKET_CNT; j++) {
+      seen += buckets[probe][j];
+      if (seen > rank) return GetBucketValue(j) / 1000.0;
+    }
+    return 0.0;
+  };
+
+  const std::ios_base::fmtflags flags = stream.flags();
+  const std::streamsize precision = stream.precision();
+  stream << "Instrumentation snapshot (" << threadCnt << " threads):\n" << std::left << std::setw(22) << "probe" << std::right
+         << std::setw(12) << "calls" << std::setw(12) << "total ms" << std::setw(11) << "mean us" << std::setw(11) << "p50 us"
+         << std::setw(11) << "p90 us" << std::setw(11) << "p99 us" << std::setw(11) << "max us" << "\n"
+         << std::fixed << std::setprecision(2);
+  for (unsigned int i = 0; i < probeCnt; i++) {
+    stream << std::left << std::setw(22) << GetProbeName((Probe) i) << std::right << std::setw(12) << callCnt[i]
+           << std::setw(12) << totalNs[i] / 1e6 << std::setw(11) << ((callCnt[i] > 0)? totalNs[i] / 1e3 / callCnt[i] : 0.0)
+           << std::setw(11) << percentileUs(i, 0.5) << std::setw(11) << percentileUs(i, 0.9) << std::setw(11)
+           << percentileUs(i, 0.99) << std::setw(11) << maxNs[i] / 1e3 << "\n";
+  }
+  stream << std::flush;
+  stream.flags(flags);
+  stream.precision(precision);
+
+  // Follow with the allocation statistics.
+  AllocStats::Dump(stream);
+}
+
+const char* Profiler::GetProbeName(const Profiler::Probe probe) {
+  switch (probe) {
+    case Probe::UpdateState: return "Game::UpdateState";
+    case Probe::Render: return "Renderer::Render";
+    case Probe::DefineAction: return "Snake::DefineAction";
+    case Probe::MlpOutput: return "MLP::GetOutput";
+    case Probe::GrowFood: return "World::GrowFood";
+    case Probe::NewGeneration: return "GenAlg::NewGeneration";
+    default: return "unknown";
+  }
+}
+
+#endif
@@ -0,0 +1,134 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+/**
+ *  Instrumentation layer timing the game's hot paths, only built if SNAKE_INSTRUMENTATION is defined (see the
+ * SNAKE_INSTRUMENTATION CMake option). Otherwise, the PROFILE_* macros expand to nothing, so the instrumented code compiles
+ * exactly as if it had none.
+ */
+#ifdef SNAKE_INSTRUMENTATION
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+/**
+ *  \brief Class aggregating the call counts and latency histograms of the instrumented code regions (probes). Each thread
+ * records into its own statistics (only written by that thread, with no read-modify-write atomic operations), which are
+ * linked into a lock-free list on the thread's first record, and summed up only when a snapshot is dumped. Latencies are
+ * kept in HDR-style log-linear histograms: one bucket range per power of two nanoseconds, split into 16 linear
+ * sub-buckets, so any latency is known within 1/16 of its value, from nanoseconds up to minutes.
+ */
+class Profiler {
+ public:
+  /**
+   *  \brief Instrumented code regions.
+   */
+  enum class Probe : uint8_t { UpdateState, Render, DefineAction, MlpOutput, GrowFood, NewGeneration, Count };
+
+  /**
+   *  \brief Scoped timer, recording the time elapsed from its construction to its destruction in a probe.
+   */
+  class Scope {
+   public:
+    explicit Scope(const Profiler::Probe probe) : probe(probe), start(std::chrono::steady_clock::now()) {}
+    ~Scope() {
+      Profiler::Record(probe, (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+    }
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+   private:
+    const Profiler::Probe probe;
+    const std::chrono::steady_clock::time_point start;
+  };
+
+  /**
+   *  \brief Records a call of a probe, in the calling thread's statistics.
+   *  \param probe The probe.
+   *  \param durationNs The call duration, in nanoseconds.
+   */
+  static void Record(const Profiler::Probe probe, const uint64_t durationNs);
+
+  /**
+   *  \brief Writes a snapshot of all threads' statistics, summed up per probe: call count, total and mean time, the 50th,
+   * 90th and 99th latency percentiles and the maximum latency.
+   *  \param stream The output stream.
+   */
+  static void Dump(std::ostream& stream);
+
+  /**
+   *  \brief Number of linear sub-buckets per power of two (as a number of bits), and number of histogram buckets per probe
+   * (covering latencies below 2^40 nanoseconds, with longer ones counted in the last bucket).
+   */
+  static constexpr unsigned int SUB_BUCKET_BITS = 4;
+  static constexpr unsigned int BUCKET_CNT = (40 - SUB_BUCKET_BITS + 1) << SUB_BUCKET_BITS;
+
+  /**
+   *  \brief Returns the histogram bucket a latency falls in.
+   *  \param valueNs The latency, in nanoseconds.
+   *  \return The bucket index.
+   */
+  static unsigned int GetBucket(const uint64_t valueNs);
+
+  /**
+   *  \brief Returns the lowest latency falling in a histogram bucket.
+   *  \param bucket The bucket index.
+   *  \return The bucket's lowest latency, in nanoseconds.
+   */
+  static uint64_t GetBucketValue(const unsigned int bucket);
+
+ private:
+  /**
+   *  \brief Statistics of a thread, per probe, and the next thread's statistics in the list.
+   */
+  struct ThreadStats {
+    std::atomic<uint64_t> callCnt[(unsigned int) Probe::Count];
+    std::atomic<uint64_t> totalNs[(unsigned int) Probe::Count];
+    std::atomic<uint64_t> maxNs[(unsigned int) Probe::Count];
+    std::atomic<uint64_t> buckets[(unsigned int) Probe::Count][BUCKET_CNT];
+    ThreadStats *next{nullptr};
+  };
+
+  /**
+   *  \brief Returns the calling thread's statistics, creating and linking them on the first call.
+   *  \return The thread's statistics.
+   */
+  static Profiler::ThreadStats& GetThreadStats();
+
+  /**
+   *  \brief Returns the name of a probe (i.e. of the instrumented function).
+   *  \param probe The probe.
+   *  \return The probe name.
+   */
+  static const char* GetProbeName(const Profiler::Probe probe);
+
+  /**
+   *  \brief Head of the list of all threads' statistics (which are kept after their threads end).
+   */
+  static std::atomic<ThreadStats*> threadStatsHead;
+};
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+
+/**
+ *  \brief Times the rest of the enclosing scope in a probe (e.g. "PROFILE_SCOPE(Render);").
+ */
+#define PROFILE_SCOPE(probe) Profiler::Scope PROFILE_CONCAT(profileScope, __LINE__)(Profiler::Probe::probe)
+
+/**
+ *  \brief Writes a snapshot of the statistics to an output stream.
+ */
+#define PROFILE_DUMP(stream) Profiler::Dump(stream)
+
+#else
+
+#define PROFILE_SCOPE(probe)
+#define PROFILE_DUMP(stream)
+
+#endif
+
+#endif
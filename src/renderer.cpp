@@ -1,14 +1,77 @@
 #include "renderer.h"
 #include <iostream>
 #include <string>
+#include <cstdio>
 #include <stdexcept>
+#include <algorithm>
+#include "config.h"
+#include "coords2D.h"
+#include "bitmapfont.h"
+#include "profiler.h"
+
+/**
+ *  \brief Color of each world element, in ARGB8888 format, indexed by the World::Element value.
+ */
+static const Uint32 elementPalette[] = {
+  0xFF1E1E1E, // None (background)
+  0xFF007ACC, // AliveSnakeHead
+  0xFFFF0000, // DeadSnakeHead
+  0xFFFFFFFF, // SnakeBody
+  0xFF808080, // Wall
+  0xFFFFCC00  // Food
+};
+
+/**
+ *  \brief Splits a text into lines of at most a given number of characters, breaking lines at '\n' characters and between
+ * words (words longer than a line are split).
+ *  \param text The text to be split.
+ *  \param maxChars Maximum number of characters per line (at least 1).
+ *  \param lines Output container, cleared and filled with the resulting lines.
+ */
+static void WrapText(const std::string& text, const std::size_t maxChars, std::vector<std::string>& lines) {
+  lines.clear();
+  std::size_t paragraphStart = 0;
+  while (paragraphStart <= text.size()) {
+    std::size_t paragraphEnd = text.find('\n', paragraphStart);
+    if (paragraphEnd == std::string::npos) paragraphEnd = text.size();
+
+    // Fill the paragraph lines with as many words as they fit.
+    std::string line;
+    std::size_t wordStart = paragraphStart;
+    while (wordStart < paragraphEnd) {
+      std::size_t wordEnd = text.find(' ', wordStart);
+      if (wordEnd == std::string::npos || wordEnd > paragraphEnd) wordEnd = paragraphEnd;
+      std::string word = text.substr(wordStart, wordEnd - wordStart);
+      wordStart = wordEnd + 1;
+      if (word.empty()) continue;
+
+      if (!line.empty() && line.size() + 1 + word.size() > maxChars) {
+        lines.push_back(line);
+        line.clear();
+      }
+      while (word.size() > maxChars) {
+        lines.push_back(word.substr(0, maxChars));
+        word.erase(0, maxChars);
+      }
+      line += (line.empty())? word : " " + word;
+    }
+    lines.push_back(line);
+
+    paragraphStart = paragraphEnd + 1;
+  }
+}
 
 Renderer::Renderer(const unsigned int winWidth,
                    const unsigned int winHeight,
-                   const unsigned int gridSideLen)
+                   const unsigned int gridSideLen,
+                   const bool offscreen)
     : winWidth(winWidth),
       winHeight(winHeight),
-      gridSideLen(gridSideLen) {
+      gridSideLen(gridSideLen),
+      streamingTexture(RENDER_STREAMING_TEXTURE) {
+  // With no display, render into the dummy video driver's window framebuffer.
+  if (offscreen) SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+
   // Initialize SDL
   if (SDL_Init(SDL_INIT_VIDEO) < 0) {
     std::cerr << "SDL could not initialize.\n";
@@ -31,8 +94,10 @@ Renderer::Renderer(const unsigned int winWidth,
     throw std::runtime_error("SDL window could not be created.");
   }
 
-  // Create renderer
-  sdlRenderer = SDL_CreateRenderer(sdlWindow, -1, SDL_RENDERER_ACCELERATED);
+  // Create renderer, falling back to the software renderer on machines with no GPU acceleration available.
+  // Offscreen, the software renderer is used right away.
+  if (!offscreen) sdlRenderer = SDL_CreateRenderer(sdlWindow, -1, SDL_RENDERER_ACCELERATED);
+  if (sdlRenderer == nullptr) sdlRenderer = SDL_CreateRenderer(sdlWindow, -1, SDL_RENDERER_SOFTWARE);
   if (sdlRenderer == nullptr) {
     std::cerr << "Renderer could not be created.\n";
     std::cerr << "SDL_Error: " << SDL_GetError() << "\n";
@@ -43,90 +108,312 @@ Renderer::Renderer(const unsigned int winWidth,
 
     throw std::runtime_error("SDL renderer could not be created.");
   }
+
+  // Create the persistent grid texture, which the grid is rendered into, in case the target texture backend is used.
+  // Otherwise, the streaming texture is only created at the first rendering, when the rendered world size is known.
+  if (!streamingTexture) {
+    gridTexture = SDL_CreateTexture(sdlRenderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, winWidth, winHeight);
+  }
+  if (!streamingTexture && gridTexture == nullptr) {
+    std::cerr << "Grid texture could not be created.\n";
+    std::cerr << "SDL_Error: " << SDL_GetError() << "\n";
+
+    // Terminate renderer, window and SDL objects that had been created.
+    SDL_DestroyRenderer(sdlRenderer);
+    SDL_DestroyWindow(sdlWindow);
+    SDL_Quit();
+
+    throw std::runtime_error("SDL grid texture could not be created.");
+  }
 }
 
 Renderer::~Renderer() {
+  if (gridTexture != nullptr) SDL_DestroyTexture(gridTexture);
   SDL_DestroyRenderer(sdlRenderer);
   SDL_DestroyWindow(sdlWindow);
   SDL_Quit();
 }
 
-void Renderer::Render(const World& world) {
+void Renderer::Render(const FrameSnapshot& frame, const Uint64 renderTimestamp, const Overlay& overlay) {
+  PROFILE_SCOPE(Render);
+
+  // Update the grid texture with the selected backend, in case the frame wasn't rendered yet.
+  // The whole grid is repainted if the frame requests it, or if the previous snapshot was skipped (along with its changes).
+  if (!textureValid || frame.sequence != renderedSequence) {
+    const bool repaintAll = !textureValid || frame.fullRedraw || frame.sequence != renderedSequence + 1;
+    if (streamingTexture) UpdateStreamingTexture(frame, repaintAll);
+    else UpdateTargetTexture(frame, repaintAll);
+    textureValid = true;
+    renderedSequence = frame.sequence;
+  }
+
   // Clear screen
   SDL_SetRenderDrawColor(sdlRenderer, 0x1E, 0x1E, 0x1E, 0xFF);
   SDL_RenderClear(sdlRenderer);
 
-  // Initialize the width and height of each screen grid unit.
-  SDL_Rect block;
-  block.w = winWidth / gridSideLen;
-  block.h = winHeight / gridSideLen;
-
-  // Starting from position (0,0), cover all grid positions, 
-  // printing to the screen according to the element in each
-  // position.
-  block.x = 0;
-  for (int i = 0; i < gridSideLen; i++) {
-    block.y = 0;
-    for (int j = 0; j < gridSideLen; j++) {
-      switch (world.GetElement({i,j})) {
-        case World::Element::Wall:
-          SDL_SetRenderDrawColor(sdlRenderer, 0x80, 0x80, 0x80, 0xFF);
-          SDL_RenderFillRect(sdlRenderer, &block);
-          break;
-        case World::Element::SnakeBody:
-          SDL_SetRenderDrawColor(sdlRenderer, 0xFF, 0xFF, 0xFF, 0xFF);
-          SDL_RenderFillRect(sdlRenderer, &block);
-          break;
-        case World::Element::AliveSnakeHead:
-          SDL_SetRenderDrawColor(sdlRenderer, 0x00, 0x7A, 0xCC, 0xFF);
-          SDL_RenderFillRect(sdlRenderer, &block);
-          break;
-        case World::Element::DeadSnakeHead:
-          SDL_SetRenderDrawColor(sdlRenderer, 0xFF, 0x00, 0x00, 0xFF);
-          SDL_RenderFillRect(sdlRenderer, &block);
-          break;
-        case World::Element::Food:
-          SDL_SetRenderDrawColor(sdlRenderer, 0xFF, 0xCC, 0x00, 0xFF);
-          SDL_RenderFillRect(sdlRenderer, &block);
-          break;
-        default: //case World::Element::None
-          // Do nothing
-          break;
+  // Copy the grid texture to the window: the streaming texture is scaled to an integer number of screen pixels (at least
+  // one) per grid cell, while the target texture already has the window size.
+  if (streamingTexture) {
+    SDL_Rect gridRect{0, 0, std::max(1, (int) winWidth / gridTextureSideLen) * gridTextureSideLen, 
+                      std::max(1, (int) winHeight / gridTextureSideLen) * gridTextureSideLen};
+    SDL_RenderCopy(sdlRenderer, gridTexture, nullptr, &gridRect);
+  } else SDL_RenderCopy(sdlRenderer, gridTexture, nullptr, nullptr);
+
+  // Draw the snakes' interpolated motion over the grid.
+  RenderMotion(frame, renderTimestamp);
+
+  // Draw the overlay message panel (if any) over everything else.
+  RenderOverlay(overlay);
+
+  // Capture the frame, if requested, before it's presented (after which the renderer's back buffer contents are undefined).
+  if (captureEncoder != nullptr) CaptureFrame();
+
+  // Update Screen
+  SDL_RenderPresent(sdlRenderer);
+}
+
+void Renderer::CaptureFrame() {
+  Uint8 *pixels = captureEncoder->AcquireFrame();
+  const SDL_Rect area{0, 0, (int) captureEncoder->GetWidth(), (int) captureEncoder->GetHeight()};
+  if (SDL_RenderReadPixels(sdlRenderer, &area, SDL_PIXELFORMAT_RGB24, pixels, area.w * 3) != 0) {
+    std::cerr << "Frame could not be captured.\n";
+    std::cerr << "SDL_Error: " << SDL_GetError() << "\n";
+    throw std::runtime_error("SDL frame could not be captured.");
+  }
+  captureEncoder->SubmitFrame();
+}
+
+unsigned int Renderer::GetDisplayRefreshRate() const {
+  SDL_DisplayMode mode;
+  const int displayIdx = SDL_GetWindowDisplayIndex(sdlWindow);
+  if (displayIdx < 0 || SDL_GetCurrentDisplayMode(displayIdx, &mode) != 0 || mode.refresh_rate <= 0) return 0;
+  return (unsigned int) mode.refresh_rate;
+}
+
+void Renderer::RenderMotion(const FrameSnapshot& frame, const Uint64 renderTimestamp) {
+  // Sub-tile motion isn't visible when grid cells are too small.
+  const int cellSize = std::max(1, (int) std::min(winWidth, winHeight) / (int) frame.gridSideLen);
+  if (cellSize < 2 || frame.ticksPerTile == 0) return;
+
+  // Number of simulation steps elapsed since the snapshot step (only while the snakes move at a steady rate).
+  double elapsedSteps = 0;
+  if (frame.stepPeriod > 0 && renderTimestamp > frame.stepTimestamp) {
+    elapsedSteps = (double) (renderTimestamp - frame.stepTimestamp) / frame.stepPeriod;
+  }
+
+  for (const SnakeMotion& motion : frame.snakes) {
+    // Fraction of the way from the current tiles to the next ones, capped at the next tile (where the simulation decides
+    // the following move).
+    const double progress = std::min(1.0, (motion.ticks + motion.speed * elapsedSteps) / frame.ticksPerTile);
+    const int offset = (int) (progress * cellSize);
+    if (offset == 0) continue;
+
+    const bool singleTile = (motion.tail == motion.head);
+    const Uint32 headColor = elementPalette[(std::size_t) World::Element::AliveSnakeHead];
+    const Uint32 bodyColor = elementPalette[(std::size_t) World::Element::SnakeBody];
+    const Uint32 backColor = elementPalette[(std::size_t) World::Element::None];
+
+    // The tail moves towards the next body part, unless the snake will grow as it enters the next tile (i.e. the next 
+    // tile holds food). It's drawn before the head, which may be right behind it.
+    const SDL_Point& next = motion.headNext;
+    const bool inside = next.x >= 0 && next.y >= 0 && next.x < (int) frame.gridSideLen && next.y < (int) frame.gridSideLen;
+    const bool growing = inside && frame.grid[(std::size_t) next.y * frame.gridSideLen + next.x] == World::Element::Food;
+    if (!singleTile && !growing) {
+      FillCell(motion.tail, SDL_Point{0,0}, 0, cellSize, backColor);
+      FillCell(motion.tail, motion.tailNext, offset, cellSize, bodyColor);
+    }
+
+    // The head tile turns into body as the head moves towards the next tile.
+    FillCell(motion.head, SDL_Point{0,0}, 0, cellSize, (singleTile)? backColor : bodyColor);
+    FillCell(motion.head, motion.headNext, offset, cellSize, headColor);
+  }
+}
+
+void Renderer::FillCell(const SDL_Point& tile, const SDL_Point& towards, const int offset, const int cellSize, 
+                        const Uint32 color) {
+  // Shift the cell by the offset, in the direction of the target tile.
+  SDL_Rect block{tile.x * cellSize, tile.y * cellSize, cellSize, cellSize};
+  if (offset > 0) {
+    block.x += (towards.x > tile.x)? offset : (towards.x < tile.x)? -offset : 0;
+    block.y += (towards.y > tile.y)? offset : (towards.y < tile.y)? -offset : 0;
+  }
+  SDL_SetRenderDrawColor(sdlRenderer, (color >> 16) & 0xFF, (color >> 8) & 0xFF, color & 0xFF, (color >> 24) & 0xFF);
+  SDL_RenderFillRect(sdlRenderer, &block);
+}
+
+void Renderer::RenderOverlay(const Overlay& overlay) {
+  if (overlay.kind == Overlay::Kind::None) return;
+
+  // Lay the panel out on a grid of font characters, with smaller characters for narrow windows.
+  const int scale = (winWidth >= 400)? OVERLAY_TEXT_SCALE : 1;
+  const int charWidth = (GLYPH_WIDTH + 1) * scale;
+  const int lineHeight = (GLYPH_HEIGHT + 3) * scale;
+  const int padding = 2 * charWidth;
+  const int panelWidth = (int) winWidth - 2 * std::max((int) winWidth / 16, scale);
+  const std::size_t maxChars = (std::size_t) std::max(1, (panelWidth - 2 * padding) / charWidth);
+
+  // Wrap the message lines again only if the overlay or the layout changed, appending the answer options of confirmations.
+  if (overlay.message != wrappedMessage || overlay.kind != wrappedKind || overlay.yesDefaultOption != wrappedYesDefault 
+      || maxChars != wrappedMaxChars) {
+    std::string text{overlay.message};
+    if (overlay.kind == Overlay::Kind::Confirmation) {
+      text += (overlay.yesDefaultOption)? "\n\nY: Yes   N: No   (Enter: Yes)" : "\n\nY: Yes   N: No   (Enter: No)";
+    }
+    WrapText(text, maxChars, overlayLines);
+    wrappedMessage = overlay.message;
+    wrappedKind = overlay.kind;
+    wrappedYesDefault = overlay.yesDefaultOption;
+    wrappedMaxChars = maxChars;
+  }
+
+  // Draw a translucent panel at the window center, with a border colored as food for confirmations, and as the snake head
+  // for notifications.
+  const int textHeight = (int) overlayLines.size() * lineHeight - (lineHeight - GLYPH_HEIGHT * scale);
+  const int panelHeight = std::min((int) winHeight, textHeight + 2 * padding);
+  const SDL_Rect panel{((int) winWidth - panelWidth) / 2, ((int) winHeight - panelHeight) / 2, panelWidth, panelHeight};
+  SDL_SetRenderDrawBlendMode(sdlRenderer, SDL_BLENDMODE_BLEND);
+  SDL_SetRenderDrawColor(sdlRenderer, 0x1E, 0x1E, 0x1E, 0xE0);
+  SDL_RenderFillRect(sdlRenderer, &panel);
+  SDL_SetRenderDrawBlendMode(sdlRenderer, SDL_BLENDMODE_NONE);
+  const Uint32 borderColor = (overlay.kind == Overlay::Kind::Confirmation)? 
+    elementPalette[(std::size_t) World::Element::Food] : elementPalette[(std::size_t) World::Element::AliveSnakeHead];
+  SDL_SetRenderDrawColor(sdlRenderer, (borderColor >> 16) & 0xFF, (borderColor >> 8) & 0xFF, borderColor & 0xFF, 0xFF);
+  SDL_RenderDrawRect(sdlRenderer, &panel);
+
+  // Collect a rectangle per lit font pixel of the (horizontally centered) lines, and fill them all at once.
+  glyphRects.clear();
+  int y = panel.y + padding;
+  for (const std::string& line : overlayLines) {
+    int x = panel.x + (panelWidth - (int) line.size() * charWidth) / 2;
+    for (const char c : line) {
+      const uint8_t *glyph = GetGlyph(c);
+      for (int row = 0; row < GLYPH_HEIGHT; row++) {
+        for (int col = 0; col < GLYPH_WIDTH; col++) {
+          if (glyph[row] & (1 << (GLYPH_WIDTH - 1 - col))) {
+            glyphRects.push_back(SDL_Rect{x + col * scale, y + row * scale, scale, scale});
+          }
+        }
       }
-      block.y += block.h;
+      x += charWidth;
     }
-    block.x += block.w;
+    y += lineHeight;
   }
+  SDL_SetRenderDrawColor(sdlRenderer, 0xFF, 0xFF, 0xFF, 0xFF);
+  if (!glyphRects.empty()) SDL_RenderFillRects(sdlRenderer, glyphRects.data(), (int) glyphRects.size());
+}
 
-  // Update Screen
-  SDL_RenderPresent(sdlRenderer);
+void Renderer::UpdateTargetTexture(const FrameSnapshot& frame, const bool repaintAll) {
+  // Draw into the persistent grid texture, instead of the window.
+  SDL_SetRenderTarget(sdlRenderer, gridTexture);
+
+  // Initialize the width and height of each screen grid unit, based on the rendered world size
+  // (which may be larger than the standard game grid, e.g. for a world shared by several snakes).
+  const int worldSideLen = frame.gridSideLen;
+  SDL_Rect block;
+  block.w = winWidth / worldSideLen;
+  block.h = winHeight / worldSideLen;
+
+  if (repaintAll) {
+    // Clear the texture and paint all of the grid tiles.
+    SDL_SetRenderDrawColor(sdlRenderer, 0x1E, 0x1E, 0x1E, 0xFF);
+    SDL_RenderClear(sdlRenderer);
+    for (int i = 0; i < worldSideLen; i++) {
+      for (int j = 0; j < worldSideLen; j++) PaintTile(frame, SDL_Point{i,j}, block);
+    }
+  } else {
+    // Otherwise, only repaint the tiles changed since the previous frame.
+    for (const SDL_Point& tile : frame.changedTiles) PaintTile(frame, tile, block);
+  }
+
+  SDL_SetRenderTarget(sdlRenderer, nullptr);
+}
+
+void Renderer::UpdateStreamingTexture(const FrameSnapshot& frame, bool repaintAll) {
+  const int worldSideLen = frame.gridSideLen;
+  const std::size_t worldArea = (std::size_t) worldSideLen * worldSideLen;
+
+  // (Re)create the streaming texture whenever the rendered world size changes, with one texture pixel per grid cell.
+  if (gridTexture == nullptr || gridTextureSideLen != worldSideLen) {
+    if (gridTexture != nullptr) SDL_DestroyTexture(gridTexture);
+    gridTexture = SDL_CreateTexture(sdlRenderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, 
+                                    worldSideLen, worldSideLen);
+    if (gridTexture == nullptr) {
+      std::cerr << "Grid texture could not be created.\n";
+      std::cerr << "SDL_Error: " << SDL_GetError() << "\n";
+      throw std::runtime_error("SDL grid texture could not be created.");
+    }
+    gridTextureSideLen = worldSideLen;
+    gridPixels.assign(worldArea, elementPalette[0]);
+    repaintAll = true;
+  }
+
+  // Map the grid elements to pixel colors: all of them, or only the tiles changed since the previous frame.
+  if (repaintAll) {
+    for (std::size_t cell = 0; cell < worldArea; cell++) gridPixels[cell] = elementPalette[(std::size_t) frame.grid[cell]];
+  } else {
+    for (const SDL_Point& tile : frame.changedTiles) {
+      const std::size_t cell = (std::size_t) tile.y * worldSideLen + tile.x;
+      gridPixels[cell] = elementPalette[(std::size_t) frame.grid[cell]];
+    }
+  }
+
+  // Upload the pixels to the texture at once.
+  SDL_UpdateTexture(gridTexture, nullptr, gridPixels.data(), worldSideLen * sizeof(Uint32));
+}
+
+void Renderer::PaintTile(const FrameSnapshot& frame, const SDL_Point& tile, SDL_Rect& block) {
+  block.x = tile.x * block.w;
+  block.y = tile.y * block.h;
+
+  // Paint the tile with the color of its element (empty tiles are painted with the background color, as they may have 
+  // held another element in the previous frame).
+  const Uint32 color = elementPalette[(std::size_t) frame.grid[(std::size_t) tile.y * frame.gridSideLen + tile.x]];
+  SDL_SetRenderDrawColor(sdlRenderer, (color >> 16) & 0xFF, (color >> 8) & 0xFF, color & 0xFF, (color >> 24) & 0xFF);
+  SDL_RenderFillRect(sdlRenderer, &block);
 }
 
-void Renderer::UpdateWindowTitle(const unsigned int score, const unsigned int fps, const unsigned int maxScorePlayer, 
-    const bool automode, const unsigned int maxScoreAI, const unsigned int genCnt, const unsigned int indCnt, 
-    const bool gamePaused) {
-  std::string title{"FPS: " + std::to_string(fps)};
+void Renderer::UpdateWindowTitle(const FrameSnapshot& frame, const unsigned int fps, const double jitterMs) {
+  char jitterText[32];
+  std::snprintf(jitterText, sizeof(jitterText), " (jitter: %.2f ms)", jitterMs);
+  std::string title{"FPS: " + std::to_string(fps) + jitterText};
 
-  if (automode) {
-    title += " / Auto";
-    title += ", Score: " + std::to_string(score);
-    title += ", Record: " + std::to_string(maxScoreAI);
+  if (frame.automode) {
+    title += (frame.lookahead)? " / Auto+Search" : " / Auto";
+    if (frame.arenaMode) title += " (Arena)";
+    if (frame.mosaicMode) title += " (Mosaic)";
+    if (frame.showcaseMode && frame.championReady) {
+      title += " (Champion of Gen " + std::to_string(frame.championGen) + ": " + std::to_string(frame.championScore) + ")";
+    } else if (frame.showcaseMode) {
+      title += " (Waiting for a champion)";
+    }
+    title += ", Score: " + std::to_string(frame.score);
+    title += ", Record: " + std::to_string(frame.maxScoreAI);
 
-    if (gamePaused) {
+    if (frame.paused) {
       title += " / Paused";
     } else {
       title += " / Learning...";
-      title += " Gen: " + std::to_string(genCnt);
-      title += ", Ind: " + std::to_string(indCnt);
+      title += " Gen: " + std::to_string(frame.genCnt);
+      title += ", Ind: " + std::to_string(frame.indCnt);
+      if (frame.speedMode) title += ", Steps/s: " + std::to_string(frame.stepsPerSec);
     }
 
   } else {
     title += " / Manual";
-    title += ", Score: " + std::to_string(score);
-    title += ", Record: " + std::to_string(maxScorePlayer);
-    if (gamePaused) {
+    title += ", Score: " + std::to_string(frame.score);
+    title += ", Record: " + std::to_string(frame.maxScorePlayer);
+    if (frame.turnCnt > 0) {
+      title += ", Input lag: " + std::to_string(frame.meanInputLatencyMs) + " ms (max " 
+        + std::to_string(frame.maxInputLatencyMs) + " ms)";
+    }
+    if (frame.paused) {
       title += " / Paused";
     }
+    if (frame.backgroundTraining) {
+      title += " / AI training... Gen: " + std::to_string(frame.genCnt);
+      title += ", Ind: " + std::to_string(frame.indCnt);
+      title += ", Record: " + std::to_string(frame.maxScoreAI);
+    }
   }
 
   SDL_SetWindowTitle(sdlWindow, title.c_str());
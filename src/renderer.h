@@ -1,8 +1,14 @@
 #ifndef RENDERER_H
 #define RENDERER_H
 
+#include <vector>
+#include <string>
+
 #include "SDL.h"
 #include "world.h"
+#include "framesnapshot.h"
+#include "overlay.h"
+#include "frameencoder.h"
 
 /**
  *  \brief Class responsible for the graphical rendering of the game.
@@ -14,8 +20,11 @@ class Renderer {
    *  \param winWidth Width of the game window, in screen coordinates.
    *  \param winHeight Height of the game window, in screen coordinates.
    *  \param gridSideLen Length of the game grid side, in game coordinates.
+   *  \param offscreen True, to render with no display (i.e. with SDL's dummy video driver and software renderer), e.g. to
+   * capture frames on a headless machine.
    */
-  Renderer(const unsigned int winWidth, const unsigned int winHeight, const unsigned int gridSideLen);
+  Renderer(const unsigned int winWidth, const unsigned int winHeight, const unsigned int gridSideLen, 
+           const bool offscreen = false);
   
   /**
    *  \brief Destructor of the Renderer class object.
@@ -23,27 +32,109 @@ class Renderer {
   ~Renderer();
 
   /**
-   *  \brief Renders current game screen state.
-   *  \param world Reference to World object.
+   *  \brief Renders a game frame.
+   * Only the tiles changed since the previously rendered snapshot are updated, unless the snapshot requests a full redraw
+   * or a snapshot was skipped. Rendering the same snapshot again only presents the current grid texture, with the snakes'
+   * head and tail motion interpolated up to the rendering time.
+   *  \param frame The frame snapshot to be rendered.
+   *  \param renderTimestamp The rendering time, as a performance counter value.
+   *  \param overlay The message panel drawn over the grid (if its kind isn't Overlay::Kind::None).
    */
-  void Render(const World& world);
+  void Render(const FrameSnapshot& frame, const Uint64 renderTimestamp, const Overlay& overlay);
+
+  /**
+   *  \brief Returns the refresh rate of the display showing the game window.
+   *  \return The display refresh rate, in Hz, or 0 if it's unknown.
+   */
+  unsigned int GetDisplayRefreshRate() const;
+
+  /**
+   *  \brief Returns the width of the game window.
+   *  \return Window width, in screen coordinates.
+   */
+  unsigned int GetWindowWidth() const { return winWidth; }
+
+  /**
+   *  \brief Returns the height of the game window.
+   *  \return Window height, in screen coordinates.
+   */
+  unsigned int GetWindowHeight() const { return winHeight; }
+
+  /**
+   *  \brief Indicates if the game window is hidden or minimized, in which case nothing needs to be rendered.
+   *  \return True, if the window isn't visible.
+   */
+  bool IsWindowHidden() const { return (SDL_GetWindowFlags(sdlWindow) & (SDL_WINDOW_HIDDEN | SDL_WINDOW_MINIMIZED)) != 0; }
 
   /**
    *  \brief Updates information shown in the window title.
-   *  \param score Current score.
-   *  \param fps Current frames per second value.
-   *  \param maxScorePlayer Maximum score that has been achieved by the player.
-   *  \param automode Flag indicating if game is in auto mode.
-   *  \param maxScoreAI Maximum score that has been achieved by the snake AI.
-   *  \param genCnt Current genetic algorithm generation.
-   *  \param indCnt Current genetic algorithm individual.
-   *  \param gamePaused Indicates if game is paused.
-   */
-  void UpdateWindowTitle(const unsigned int score, const unsigned int fps, const unsigned int maxScorePlayer, 
-    const bool automode, const unsigned int maxScoreAI, const unsigned int genCnt, 
-    const unsigned int indCnt, const bool gamePaused);
+   *  \param frame The latest frame snapshot, holding the scores and the game modes and state.
+   *  \param fps Current (rendered) frames per second value.
+   *  \param jitterMs Current frame period jitter (i.e. standard deviation), in milliseconds.
+   */
+  void UpdateWindowTitle(const FrameSnapshot& frame, const unsigned int fps, const double jitterMs);
+
+  /**
+   *  \brief Sets the encoder every rendered frame is captured to (read back from the renderer right before being presented).
+   *  \param encoder The frame encoder, whose frame size shall be the window size, or null to stop capturing.
+   */
+  void SetCaptureEncoder(FrameEncoder *encoder) { this->captureEncoder = encoder; }
 
  private:
+  /**
+   *  \brief Reads the rendered frame's pixels back into a buffer of the capture encoder, and submits it for encoding.
+   */
+  void CaptureFrame();
+
+  /**
+   *  \brief Target texture backend: repaints the changed tiles (one filled rectangle each) into a persistent target texture
+   * with the size of the window.
+   *  \param frame The frame snapshot being rendered.
+   *  \param repaintAll Indicates if all grid tiles shall be repainted, instead of only the changed ones.
+   */
+  void UpdateTargetTexture(const FrameSnapshot& frame, const bool repaintAll);
+
+  /**
+   *  \brief Streaming texture backend: maps the changed tiles' elements to pixels of a buffer with one pixel per grid cell,
+   * and uploads the buffer to a streaming texture, which is later presented with a single scaled copy to the window.
+   * This backend keeps up with large grids, and works with the SDL software renderer as well.
+   *  \param frame The frame snapshot being rendered.
+   *  \param repaintAll Indicates if all grid tiles shall be repainted, instead of only the changed ones.
+   */
+  void UpdateStreamingTexture(const FrameSnapshot& frame, bool repaintAll);
+
+  /**
+   *  \brief Draws the snakes' heads and tails over the grid at their interpolated positions, between the grid tiles they
+   * occupy at the snapshot step and the next ones.
+   *  \param frame The frame snapshot being rendered.
+   *  \param renderTimestamp The rendering time, as a performance counter value.
+   */
+  void RenderMotion(const FrameSnapshot& frame, const Uint64 renderTimestamp);
+
+  /**
+   *  \brief Draws an overlay message panel at the center of the window, with the built-in bitmap font.
+   *  \param overlay The overlay to be drawn (nothing is drawn if its kind is Overlay::Kind::None).
+   */
+  void RenderOverlay(const Overlay& overlay);
+
+  /**
+   *  \brief Fills a grid cell-sized rectangle in the window, optionally shifted towards an adjacent tile.
+   *  \param tile The grid position of the cell.
+   *  \param towards The grid position of the tile the cell is shifted towards (only used if the offset is positive).
+   *  \param offset The shift, in screen coordinates.
+   *  \param cellSize The side length of a grid cell, in screen coordinates.
+   *  \param color The fill color, in ARGB8888 format.
+   */
+  void FillCell(const SDL_Point& tile, const SDL_Point& towards, const int offset, const int cellSize, const Uint32 color);
+
+  /**
+   *  \brief Paints a single grid tile into the current render target, with the color of its element.
+   *  \param frame The frame snapshot being rendered.
+   *  \param tile The grid position of the tile to be painted.
+   *  \param block Screen rectangle of a grid tile, whose size is kept and whose position is overwritten.
+   */
+  void PaintTile(const FrameSnapshot& frame, const SDL_Point& tile, SDL_Rect& block);
+
   /**
    *  \brief The SDL library window object.
    */
@@ -52,7 +143,52 @@ class Renderer {
   /**
    *  \brief The SDL library renderer object.
    */
-  SDL_Renderer *sdlRenderer;
+  SDL_Renderer *sdlRenderer{nullptr};
+
+  /**
+   *  \brief Persistent texture holding the rendered grid, which is copied to the window at every frame.
+   */
+  SDL_Texture *gridTexture{nullptr};
+
+  /**
+   *  \brief Pixels of the streaming grid texture, one per grid cell in row-major order (streaming texture backend only).
+   */
+  std::vector<Uint32> gridPixels;
+
+  /**
+   *  \brief Side length of the streaming grid texture, in pixels (i.e. grid cells).
+   */
+  int gridTextureSideLen{0};
+
+  /**
+   *  \brief Indicates if the grid texture depicts a rendered snapshot.
+   */
+  bool textureValid{false};
+
+  /**
+   *  \brief Sequence number of the snapshot the grid texture depicts.
+   */
+  unsigned long renderedSequence{0};
+
+  /**
+   *  \brief Lines of the latest drawn overlay text, wrapped to the panel width, and the overlay state and maximum line 
+   * length they were wrapped for (so the text is only wrapped again when it changes).
+   */
+  std::vector<std::string> overlayLines;
+  std::string wrappedMessage;
+  Overlay::Kind wrappedKind{Overlay::Kind::None};
+  bool wrappedYesDefault{false};
+  std::size_t wrappedMaxChars{0};
+
+  /**
+   *  \brief Rectangles of the lit font pixels of the overlay text, filled at once.
+   */
+  std::vector<SDL_Rect> glyphRects;
+
+  /**
+   *  \brief Encoder the rendered frames are captured to, if any.
+   */
+  FrameEncoder *captureEncoder{nullptr};
 
   /**
    *  \brief The width of the game screen window, in screen coordinates.
@@ -68,6 +204,11 @@ class Renderer {
    *  \brief The side length of the square game grid, in game coordinates units.
    */
   const unsigned int gridSideLen;
+
+  /**
+   *  \brief Indicates if the streaming texture backend is used (true), or the target texture one (false).
+   */
+  const bool streamingTexture;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,324 @@
+#include "replay.h"
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+#include "config.h"
+
+/**
+ *  \brief Replay file signature and format version.
+ */
+#define REPLAY_FILE_MAGIC "SNAKERPL"
+#define REPLAY_FILE_VERSION 1
+
+/**
+ *  \brief Writes an unsigned integer to a binary stream, as a fixed number of little-endian bytes.
+ *  \param file The output stream.
+ *  \param value The value.
+ *  \param size Number of bytes.
+ */
+static void WriteUint(std::ostream& file, const uint64_t value, const unsigned int size) {
+  for (unsigned int i = 0; i < size; i++) file.put((char) ((value >> (8 * i)) & 0xFF));
+}
+
+/**
+ *  \brief Reads an unsigned integer written by WriteUint from a binary stream. If the stream ends before the value, a runtime
+ * exception is raised.
+ *  \param file The input stream.
+ *  \param size Number of bytes.
+ *  \return The value.
+ */
+static uint64_t ReadUint(std::istream& file, const unsigned int size) {
+  uint64_t value = 0;
+  for (unsigned int i = 0; i < size; i++) {
+    const int byte = file.get();
+    if (byte == std::char_traits<char>::eof()) throw std::runtime_error("Replay file is truncated.");
+    value |= (uint64_t) byte << (8 * i);
+  }
+  return value;
+}
+
+/**
+ *  \brief Writes a grid position to a binary stream.
+ *  \param file The output stream.
+ *  \param position The position.
+ */
+static void WritePoint(std::ostream& file, const SDL_Point& position) {
+  WriteUint(file, (uint32_t) position.x, 4);
+  WriteUint(file, (uint32_t) position.y, 4);
+}
+
+/**
+ *  \brief Reads a grid position written by WritePoint from a binary stream.
+ *  \param file The input stream.
+ *  \return The position.
+ */
+static SDL_Point ReadPoint(std::istream& file) {
+  const int x = (int) (uint32_t) ReadUint(file, 4);
+  const int y = (int) (uint32_t) ReadUint(file, 4);
+  return SDL_Point{x, y};
+}
+
+/**
+ *  \brief Returns the direction from a grid position to an adjacent one.
+ *  \param from The first position.
+ *  \param to The adjacent position.
+ *  \return The direction. If the positions aren't adjacent, a runtime exception is raised.
+ */
+static Direction2D GetDirectionTo(const SDL_Point& from, const SDL_Point& to) {
+  for (const Direction2D direction : {Direction2D::Up, Direction2D::Right, Direction2D::Down, Direction2D::Left}) {
+    if (GetAdjPosition(from, direction) == to) return direction;
+  }
+  throw std::runtime_error("Snake body parts recorded in a replay keyframe aren't adjacent.");
+}
+
+void Replay::Start(const Snake& snake, const World& world, const unsigned int seed) {
+  this->gridSideLen = world.GetGridSideLen();
+  this->startPosition = snake.GetHeadPosition();
+  this->startDirection = snake.GetDirection();
+  this->direction = startDirection;
+  this->seed = seed;
+  this->endCause = EndCause::Unfinished;
+  this->score = 0;
+  this->tileCnt = 0;
+  this->actionCnt = 0;
+  this->packedActions.clear();
+  this->keyframes.clear();
+}
+
+void Replay::RecordTile(const Snake& snake, const World& world) {
+  if (IsOver()) return;
+  tileCnt++;
+  score = (unsigned int) (snake.GetSize() - 1);
+
+  // If the round ended at the tile, no action was taken there (or it doesn't matter, in case of a victory).
+  if (!snake.IsAlive()) {
+    endCause = GetEndCause(snake.GetDeathCause());
+    return;
+  } else if (!world.HasFood()) {
+    endCause = EndCause::Victory;
+    return;
+  }
+
+  // The snake's action is its turn at the tile, relative to its previous direction (which also covers the player's tiles
+  // with no turn taken).
+  const Direction2D newDirection = snake.GetDirection();
+  if (newDirection == direction) PushAction(Snake::Action::MoveFwd);
+  else if (newDirection == GetLeftOf(direction)) PushAction(Snake::Action::MoveLeft);
+  else PushAction(Snake::Action::MoveRight);
+  direction = newDirection;
+
+  // Record a keyframe at regular intervals.
+  if (actionCnt % REPLAY_KEYFRAME_INTERVAL == 0) {
+    const RingBuffer<SDL_Point>& positions = snake.GetPositions();
+    keyframes.push_back(Keyframe{tileCnt, std::vector<SDL_Point>(positions.begin(), positions.end()), direction,
+                                 world.GetFoodPosition(), world.GetRandGenerator()});
+  }
+}
+
+void Replay::PushAction(const Snake::Action action) {
+  if (actionCnt % 4 == 0) packedActions.push_back(0);
+  packedActions.back() |= (uint8_t) ((unsigned int) action << (2 * (actionCnt % 4)));
+  actionCnt++;
+}
+
+const Replay::Keyframe* Replay::FindKeyframe(const unsigned long tileCnt) const {
+  auto next = std::upper_bound(keyframes.begin(), keyframes.end(), tileCnt,
+                               [](const unsigned long cnt, const Keyframe& keyframe) { return cnt < keyframe.tileCnt; });
+  return (next == keyframes.begin())? nullptr : &*(next - 1);
+}
+
+const char* Replay::GetEndCauseName(const EndCause endCause) {
+  switch (endCause) {
+    case EndCause::Wall: return "wall";
+    case EndCause::Body: return "body";
+    case EndCause::Loop: return "loop";
+    case EndCause::Victory: return "victory";
+    default: return "unfinished";
+  }
+}
+
+Replay::EndCause Replay::GetEndCause(const Snake::DeathCause deathCause) {
+  switch (deathCause) {
+    case Snake::DeathCause::Wall: return EndCause::Wall;
+    case Snake::DeathCause::Body: return EndCause::Body;
+    case Snake::DeathCause::Loop: return EndCause::Loop;
+    default: return EndCause::Unfinished;
+  }
+}
+
+void Replay::Store(const std::string& path) const {
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file.is_open()) throw std::runtime_error("Couldn't write replay file \"" + path + "\".");
+
+  // Header: signature, version, initial state and round outcome.
+  file.write(REPLAY_FILE_MAGIC, sizeof(REPLAY_FILE_MAGIC) - 1);
+  WriteUint(file, REPLAY_FILE_VERSION, 2);
+  WriteUint(file, gridSideLen, 4);
+  WritePoint(file, startPosition);
+  WriteUint(file, (uint8_t) startDirection, 1);
+  WriteUint(file, seed, 4);
+  WriteUint(file, (uint8_t) endCause, 1);
+  WriteUint(file, score, 4);
+  WriteUint(file, tileCnt, 8);
+
+  // Actions stream, 2 bits per action.
+  WriteUint(file, actionCnt, 8);
+  file.write((const char*) packedActions.data(), packedActions.size());
+
+  // Keyframes, with the snake body stored as its head position followed by the direction from each part to the next one,
+  // 2 bits each, and the random number generator state in its standard text representation.
+  WriteUint(file, keyframes.size(), 4);
+  for (const Keyframe& keyframe : keyframes) {
+    WriteUint(file, keyframe.tileCnt, 8);
+    WriteUint(file, (uint8_t) keyframe.direction, 1);
+    WritePoint(file, keyframe.foodPosition);
+    WriteUint(file, keyframe.positions.size(), 4);
+    WritePoint(file, keyframe.positions.front());
+    uint8_t links = 0;
+    for (std::size_t i = 1; i < keyframe.positions.size(); i++) {
+      links |= (uint8_t) ((unsigned int) GetDirectionTo(keyframe.positions[i - 1], keyframe.positions[i]) << (2 * ((i - 1) % 4)));
+      if ((i - 1) % 4 == 3 || i == keyframe.positions.size() - 1) {
+        file.put((char) links);
+        links = 0;
+      }
+    }
+    std::ostringstream randState;
+    randState << keyframe.randGenerator;
+    WriteUint(file, randState.str().size(), 2);
+    file << randState.str();
+  }
+
+  if (!file.good()) throw std::runtime_error("Couldn't write replay file \"" + path + "\".");
+}
+
+void Replay::Load(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file.is_open()) throw std::runtime_error("Couldn't read replay file \"" + path + "\".");
+
+  char magic[sizeof(REPLAY_FILE_MAGIC) - 1];
+  file.read(magic, sizeof(magic));
+  if (!file.good() || std::string(magic, sizeof(magic)) != REPLAY_FILE_MAGIC || ReadUint(file, 2) != REPLAY_FILE_VERSION) {
+    throw std::runtime_error("File \"" + path + "\" isn't a supported replay file.");
+  }
+
+  // Header.
+  gridSideLen = (unsigned int) ReadUint(file, 4);
+  startPosition = ReadPoint(file);
+  startDirection = (Direction2D) (ReadUint(file, 1) & 0x3);
+  direction = startDirection;
+  seed = (unsigned int) ReadUint(file, 4);
+  const uint64_t cause = ReadUint(file, 1);
+  if (cause > (uint64_t) EndCause::Victory) throw std::runtime_error("Replay file has an invalid end cause.");
+  endCause = (EndCause) cause;
+  score = (unsigned int) ReadUint(file, 4);
+  tileCnt = (unsigned long) ReadUint(file, 8);
+
+  // Actions stream.
+  actionCnt = (unsigned long) ReadUint(file, 8);
+  if (actionCnt > tileCnt) throw std::runtime_error("Replay file has more actions than tiles.");
+  packedActions.resize((actionCnt + 3) / 4);
+  file.read((char*) packedActions.data(), packedActions.size());
+  if (!file.good()) throw std::runtime_error("Replay file is truncated.");
+
+  // Keyframes.
+  keyframes.clear();
+  const uint64_t keyframeCnt = ReadUint(file, 4);
+  for (uint64_t k = 0; k < keyframeCnt; k++) {
+    Keyframe keyframe;
+    keyframe.tileCnt = (unsigned long) ReadUint(file, 8);
+    keyframe.direction = (Direction2D) (ReadUint(file, 1) & 0x3);
+    keyframe.foodPosition = ReadPoint(file);
+    const uint64_t size = ReadUint(file, 4);
+    if (size == 0 || size > (uint64_t) gridSideLen * gridSideLen || (!keyframes.empty() && keyframe.tileCnt <= keyframes.back().tileCnt)) {
+      throw std::runtime_error("Replay file has an invalid keyframe.");
+    }
+    keyframe.positions.reserve(size);
+    keyframe.positions.push_back(ReadPoint(file));
+    uint8_t links = 0;
+    for (uint64_t i = 1; i < size; i++) {
+      if ((i - 1) % 4 == 0) links = (uint8_t) ReadUint(file, 1);
+      const Direction2D link = (Direction2D) ((links >> (2 * ((i - 1) % 4))) & 0x3);
+      keyframe.positions.push_back(GetAdjPosition(keyframe.positions.back(), link));
+    }
+    std::string randState(ReadUint(file, 2), '\0');
+    file.read(&randState[0], randState.size());
+    std::istringstream randStream(randState);
+    randStream >> keyframe.randGenerator;
+    if (!file.good() || randStream.fail()) throw std::runtime_error("Replay file has an invalid keyframe.");
+    keyframes.push_back(std::move(keyframe));
+  }
+}
+
+ReplayPlayer::ReplayPlayer(const Replay& replay)
+  : replay(replay),
+    world(replay.GetGridSideLen()),
+    snake(replay.GetStartPosition(), world, nullptr) {
+  // The replay snake has no use for a genetic algorithm, as it never takes decisions.
+  Restart();
+}
+
+void ReplayPlayer::Restart() {
+  // Initialize the world and the snake in the same order as the recorded round.
+  world.Init(replay.GetSeed());
+  snake.Init(std::vector<SDL_Point>{replay.GetStartPosition()}, replay.GetStartDirection());
+  tileCnt = 0;
+  endCause = Replay::EndCause::Unfinished;
+  over = false;
+  CheckUnfinishedEnd();
+}
+
+void ReplayPlayer::Resume(const Replay::Keyframe& keyframe) {
+  // The grid is rebuilt from the keyframe: walls first, then the snake body and the food, and the random number generator
+  // state is restored last, as placing the initial food draws from it.
+  world.Init();
+  snake.Init(keyframe.positions, keyframe.direction);
+  world.PlaceFood(keyframe.foodPosition);
+  world.SetRandGenerator(keyframe.randGenerator);
+  tileCnt = keyframe.tileCnt;
+  endCause = Replay::EndCause::Unfinished;
+  over = false;
+  CheckUnfinishedEnd();
+}
+
+bool ReplayPlayer::Step() {
+  if (over) return false;
+
+  // Move the snake until its head enters a new tile (resolving its content, e.g. eating or collision).
+  do snake.Update(); while (snake.GetEvent() == Snake::Event::SameTile);
+  tileCnt++;
+
+  if (!snake.IsAlive()) {
+    endCause = Replay::GetEndCause(snake.GetDeathCause());
+    over = true;
+  } else if (snake.GetEvent() == Snake::Event::Ate && !world.HasFood()) {
+    endCause = Replay::EndCause::Victory;
+    over = true;
+  } else if (tileCnt <= replay.GetActionCnt()) {
+    snake.Act(replay.GetAction(tileCnt - 1));
+    CheckUnfinishedEnd();
+  } else {
+    // The recorded round ended at this tile with the snake still alive under the world rules, which is only consistent with
+    // an endless loop kill. Otherwise, the replay diverged from the recording, and stops as unfinished.
+    if (replay.GetEndCause() == Replay::EndCause::Loop) {
+      snake.SetEvent(Snake::Event::Killed);
+      endCause = Replay::EndCause::Loop;
+    }
+    over = true;
+  }
+  return true;
+}
+
+void ReplayPlayer::Seek(const unsigned long tileCnt) {
+  // Resume from the closest keyframe before the target point, unless the current point is closer (or the round start).
+  const Replay::Keyframe *keyframe = replay.FindKeyframe(tileCnt);
+  if (tileCnt < this->tileCnt || (keyframe != nullptr && keyframe->tileCnt > this->tileCnt)) {
+    if (keyframe != nullptr) Resume(*keyframe);
+    else Restart();
+  }
+  while (this->tileCnt < tileCnt && Step()) {}
+}
+
+void ReplayPlayer::CheckUnfinishedEnd() {
+  if (!replay.IsOver() && tileCnt >= replay.GetActionCnt()) over = true;
+}
@@ -0,0 +1,324 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <vector>
+#include <string>
+#include <random>
+#include <cstdint>
+
+#include "world.h"
+#include "snake.h"
+#include "coords2D.h"
+#include "SDL.h"
+
+/**
+ *  \brief Class recording a single snake game round as a compact replay: the world's random number generator seed, the
+ * round's initial state, and the snake's action (forward, left or right) at each grid tile it entered, packed in 2 bits each.
+ * As the food placements only depend on the seed and on the tiles occupied by the snake, re-simulating the actions under the
+ * same World rules reproduces the round exactly (see ReplayPlayer), whether the snake was controlled by the player or the AI.
+ * Keyframes holding the whole round state are recorded at regular intervals (see REPLAY_KEYFRAME_INTERVAL), so that the
+ * round can be resumed at any point with no more than one interval re-simulated.
+ */
+class Replay {
+ public:
+  /**
+   *  \brief Round end cause enum: not finished (yet), snake collision with a wall or with its own body, snake killed in an
+   * endless loop (in auto mode), or victory.
+   */
+  enum class EndCause : uint8_t { Unfinished, Wall, Body, Loop, Victory };
+
+  /**
+   *  \brief Whole round state, right after the snake entered a grid tile and took its action there.
+   */
+  struct Keyframe {
+    /**
+     *  \brief Number of grid tiles entered (i.e. actions taken) so far in the round.
+     */
+    unsigned long tileCnt;
+
+    /**
+     *  \brief The snake's head and body parts positions, ordered from the head to the tail, and its direction.
+     */
+    std::vector<SDL_Point> positions;
+    Direction2D direction;
+
+    /**
+     *  \brief The food position.
+     */
+    SDL_Point foodPosition;
+
+    /**
+     *  \brief The world's random number generator state, which determines the next food placements.
+     */
+    std::default_random_engine randGenerator;
+  };
+
+  /**
+   *  \brief Starts recording a new round, discarding the previous recording. Shall be called right after the world and the
+   * snake are initialized for the round.
+   *  \param snake The round's snake, at its starting position.
+   *  \param world The round's world, initialized from the seed.
+   *  \param seed The seed the world's random number generator was initialized with.
+   */
+  void Start(const Snake& snake, const World& world, const unsigned int seed);
+
+  /**
+   *  \brief Records the outcome of the snake entering a new grid tile: its action at the tile (and a keyframe, at each
+   * REPLAY_KEYFRAME_INTERVAL actions), or the round's end. Shall be called after every snake update resulting in a new tile
+   * event (i.e. other than Snake::Event::SameTile). Once the round is over, further calls are ignored.
+   *  \param snake The round's snake.
+   *  \param world The round's world.
+   */
+  void RecordTile(const Snake& snake, const World& world);
+
+  /**
+   *  \brief Stores the replay in a binary file. If the file can't be written, a runtime exception is raised.
+   *  \param path The file path.
+   */
+  void Store(const std::string& path) const;
+
+  /**
+   *  \brief Loads a replay from a binary file, replacing the current one. If the file can't be read or isn't a valid replay,
+   * a runtime exception is raised.
+   *  \param path The file path.
+   */
+  void Load(const std::string& path);
+
+  /**
+   *  \brief Returns the length of the round's world grid side.
+   *  \return The square world's width/height, in number of grid cells.
+   */
+  unsigned int GetGridSideLen() const { return gridSideLen; }
+
+  /**
+   *  \brief Returns the snake's starting position and direction.
+   *  \return The snake's starting head position in the world grid.
+   */
+  SDL_Point GetStartPosition() const { return startPosition; }
+  Direction2D GetStartDirection() const { return startDirection; }
+
+  /**
+   *  \brief Returns the seed the world's random number generator was initialized with.
+   *  \return The world seed.
+   */
+  unsigned int GetSeed() const { return seed; }
+
+  /**
+   *  \brief Returns the number of grid tiles the snake entered in the round (including the one it died in, if any).
+   *  \return Number of tiles, i.e. the round steps.
+   */
+  unsigned long GetTileCnt() const { return tileCnt; }
+
+  /**
+   *  \brief Returns the number of recorded actions, i.e. of tiles the snake entered and survived in (without winning).
+   *  \return Number of actions.
+   */
+  unsigned long GetActionCnt() const { return actionCnt; }
+
+  /**
+   *  \brief Returns a recorded action.
+   *  \param idx Index of the action, from 0 to GetActionCnt() - 1 (i.e. the action taken at tile idx + 1).
+   *  \return The action.
+   */
+  Snake::Action GetAction(const unsigned long idx) const {
+    return (Snake::Action) ((packedActions[idx / 4] >> (2 * (idx % 4))) & 0x3);
+  }
+
+  /**
+   *  \brief Returns the round's end cause.
+   *  \return End cause, or EndCause::Unfinished if the recorded round isn't over.
+   */
+  EndCause GetEndCause() const { return endCause; }
+
+  /**
+   *  \brief Indicates if the recorded round is over.
+   *  \return True, if the round ended; false, otherwise.
+   */
+  bool IsOver() const { return endCause != EndCause::Unfinished; }
+
+  /**
+   *  \brief Returns the round's score, at its end (or at the latest recorded tile).
+   *  \return Score, in points.
+   */
+  unsigned int GetScore() const { return score; }
+
+  /**
+   *  \brief Returns the keyframes recorded so far.
+   *  \return Const reference to the keyframes, in recording order.
+   */
+  const std::vector<Keyframe>& GetKeyframes() const { return keyframes; }
+
+  /**
+   *  \brief Finds the latest keyframe recorded at or before a given round point.
+   *  \param tileCnt The round point, as the number of tiles entered.
+   *  \return Pointer to the keyframe, or nullptr if there's none (i.e. the round has to be replayed from its start).
+   */
+  const Keyframe* FindKeyframe(const unsigned long tileCnt) const;
+
+  /**
+   *  \brief Returns the name of a round end cause, e.g. for reports.
+   *  \param endCause The end cause.
+   *  \return End cause name, in lowercase.
+   */
+  static const char* GetEndCauseName(const EndCause endCause);
+
+  /**
+   *  \brief Returns the round end cause corresponding to a snake death cause.
+   *  \param deathCause The snake death cause.
+   *  \return End cause (EndCause::Unfinished, if the snake is alive).
+   */
+  static EndCause GetEndCause(const Snake::DeathCause deathCause);
+
+ private:
+  /**
+   *  \brief Appends an action to the packed actions stream.
+   *  \param action The action.
+   */
+  void PushAction(const Snake::Action action);
+
+  /**
+   *  \brief The round's world grid side length, and the snake's starting position and direction.
+   */
+  unsigned int gridSideLen{0};
+  SDL_Point startPosition{0, 0};
+  Direction2D startDirection{Direction2D::Up};
+
+  /**
+   *  \brief The world's random number generator seed.
+   */
+  unsigned int seed{0};
+
+  /**
+   *  \brief The round's end cause and score.
+   */
+  EndCause endCause{EndCause::Unfinished};
+  unsigned int score{0};
+
+  /**
+   *  \brief Number of tiles entered, and of actions recorded.
+   */
+  unsigned long tileCnt{0};
+  unsigned long actionCnt{0};
+
+  /**
+   *  \brief The actions stream, with 4 actions per byte, from the least significant bits on.
+   */
+  std::vector<uint8_t> packedActions;
+
+  /**
+   *  \brief The keyframes, in recording order.
+   */
+  std::vector<Keyframe> keyframes;
+
+  /**
+   *  \brief The snake's direction after its latest recorded action (while recording).
+   */
+  Direction2D direction{Direction2D::Up};
+};
+
+/**
+ *  \brief Class re-simulating a recorded round (see Replay) tile by tile, in its own world and with its own snake, applying
+ * the recorded actions instead of taking decisions. The replay can be moved to any round point, resuming from the closest
+ * keyframe before it.
+ */
+class ReplayPlayer {
+ public:
+  /**
+   *  \brief Constructor of the ReplayPlayer class object. The replay is started from the beginning of the round.
+   *  \param replay The replay to be played, which shall outlive the player and not be changed meanwhile.
+   */
+  explicit ReplayPlayer(const Replay& replay);
+
+  /**
+   *  \brief Restarts the replay from the beginning of the round, re-initializing the world from the recorded seed.
+   */
+  void Restart();
+
+  /**
+   *  \brief Moves the snake until it enters the next grid tile, and applies the recorded action there. In case the round
+   * ended at the tile, it's replayed as recorded only if the world rules lead to the same end (except for a kill in an
+   * endless loop, which is an AI mode rule, and thus applied as recorded).
+   *  \return True, if a tile was replayed; false, if the replay is over.
+   */
+  bool Step();
+
+  /**
+   *  \brief Moves the replay to a given round point, from the closest keyframe before it (or from the current point or the
+   * round start, if closer), stepping tile by tile from there.
+   *  \param tileCnt The round point, as the number of tiles entered. The replay stops earlier in case the round is over.
+   */
+  void Seek(const unsigned long tileCnt);
+
+  /**
+   *  \brief Indicates if the replay is over, i.e. if the replayed round ended, or all its recorded actions were replayed.
+   *  \return True, if there are no tiles left to be replayed; false, otherwise.
+   */
+  bool IsOver() const { return over; }
+
+  /**
+   *  \brief Returns the replayed round's end cause, as re-simulated.
+   *  \return End cause, or Replay::EndCause::Unfinished if the replayed round didn't end (yet).
+   */
+  Replay::EndCause GetEndCause() const { return endCause; }
+
+  /**
+   *  \brief Returns the number of tiles entered so far in the replayed round.
+   *  \return Number of tiles.
+   */
+  unsigned long GetTileCnt() const { return tileCnt; }
+
+  /**
+   *  \brief Returns the current replayed round score.
+   *  \return Score, in points.
+   */
+  unsigned int GetScore() const { return (unsigned int) (snake.GetSize() - 1); }
+
+  /**
+   *  \brief Returns the replay world, e.g. for rendering.
+   *  \return Const reference to the world.
+   */
+  const World& GetWorld() const { return world; }
+
+  /**
+   *  \brief Returns the replay snake.
+   *  \return Const reference to the snake.
+   */
+  const Snake& GetSnake() const { return snake; }
+
+ private:
+  /**
+   *  \brief Resumes the replay from a keyframe.
+   *  \param keyframe The keyframe.
+   */
+  void Resume(const Replay::Keyframe& keyframe);
+
+  /**
+   *  \brief Marks the replay as over if the recorded round is unfinished and all its actions were replayed.
+   */
+  void CheckUnfinishedEnd();
+
+  /**
+   *  \brief The replay being played.
+   */
+  const Replay& replay;
+
+  /**
+   *  \brief The replay world and snake. The snake is kept in manual mode, with no player commands, so that it only takes the
+   * recorded actions.
+   */
+  World world;
+  Snake snake;
+
+  /**
+   *  \brief Number of tiles entered so far.
+   */
+  unsigned long tileCnt{0};
+
+  /**
+   *  \brief The replayed round end cause, and whether the replay is over.
+   */
+  Replay::EndCause endCause{Replay::EndCause::Unfinished};
+  bool over{false};
+};
+
+#endif
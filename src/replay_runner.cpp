@@ -0,0 +1,215 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <random>
+#include <stdexcept>
+#include <algorithm>
+#include <exception>
+
+#include "world.h"
+#include "snake.h"
+#include "replay.h"
+#include "config.h"
+#include "profiler.h"
+#include "allocstats.h"
+
+/**
+ *  File implementing a headless replay regression runner: it re-simulates recorded game rounds (see Replay) in parallel, as
+ * fast as possible, and checks that each one still ends with the recorded score, number of steps (tiles) and end cause. Any
+ * change to the World or Snake rules (or to their optimizations) can then be checked for behavioral equivalence against a
+ * corpus of replays recorded before it, which can also be generated by the runner itself.
+ */
+
+/**
+ *  \brief Outcome of the re-simulation of one replay.
+ */
+struct ReplayResult {
+  unsigned int score;
+  unsigned long tileCnt;
+  Replay::EndCause endCause;
+};
+
+/**
+ *  \brief Prints the command line usage.
+ */
+void PrintUsage() {
+  std::cout << "Usage:\n"
+               "  SnakeReplay [--threads <count>] [--repeat <count>] <replay files...>\n"
+               "    Re-simulates the replays and checks their score, steps and end cause against the recording.\n"
+               "  SnakeReplay --generate <count> <path prefix> [grid side length]\n"
+               "    Records AI rounds (with the AI learning between them) as replay files named after the prefix.\n";
+}
+
+/**
+ *  \brief Parses an unsigned integer command line argument value. If it's not an unsigned integer, a runtime exception is
+ * raised.
+ *  \param arg The argument value.
+ *  \return The parsed value.
+ */
+unsigned long ParseCount(const std::string& arg) {
+  std::size_t parsedLen = 0;
+  unsigned long value = 0;
+  try { value = std::stoul(arg, &parsedLen); } catch(const std::exception&) { parsedLen = 0; }
+  if (parsedLen == 0 || parsedLen != arg.size() || arg[0] == '-') {
+    throw std::runtime_error("Invalid count \"" + arg + "\" (expected an unsigned integer).");
+  }
+  return value;
+}
+
+/**
+ *  \brief Plays AI-controlled rounds as done by the game in auto mode, and stores each one as a replay file.
+ *  \param count Number of rounds.
+ *  \param pathPrefix Prefix of the replay files paths, followed by the round number and the ".replay" extension.
+ *  \param gridSideLen The square world grid's width/height, in number of grid cells.
+ */
+void GenerateReplays(const unsigned long count, const std::string& pathPrefix, const unsigned int gridSideLen) {
+  World world(gridSideLen);
+  Snake snake(SDL_Point{(int) gridSideLen / 2, (int) gridSideLen / 2}, world);
+  snake.SetAutoMode(true);
+  std::default_random_engine seedGenerator(std::chrono::system_clock::now().time_since_epoch().count());
+  Replay replay;
+
+  for (unsigned long i = 0; i < count; i++) {
+    const unsigned int seed = (unsigned int) seedGenerator();
+    world.Init(seed);
+    snake.Init();
+    replay.Start(snake, world, seed);
+    while (snake.IsAlive() && world.HasFood()) {
+      snake.Update();
+      if (snake.GetEvent() != Snake::Event::SameTile) replay.RecordTile(snake, world);
+    }
+    snake.GradeFitness((float) snake.GetSize());
+
+    std::string number = std::to_string(i);
+    number.insert(0, (number.size() < 6)? 6 - number.size() : 0, '0');
+    replay.Store(pathPrefix + number + ".replay");
+  }
+  std::cout << "Recorded " << count << " replays (" << snake.GetGenAlgGeneration() << " AI generations)." << std::endl;
+}
+
+/**
+ *  \brief Re-simulates the replays in parallel, checks their outcomes and prints the throughput and any mismatch.
+ *  \param paths The replay files paths.
+ *  \param threadCnt Number of worker threads.
+ *  \param repeatCnt Number of times each replay is re-simulated (e.g. to measure the throughput over few replays).
+ *  \return Number of replays whose outcome doesn't match the recording.
+ */
+unsigned long RunReplays(const std::vector<std::string>& paths, const unsigned int threadCnt, const unsigned int repeatCnt) {
+  using Clock = std::chrono::steady_clock;
+
+  // Load all replays first, so that only the re-simulation is measured.
+  std::vector<Replay> replays(paths.size());
+  for (std::size_t i = 0; i < paths.size(); i++) replays[i].Load(paths[i]);
+
+  // Each worker claims the next replay to be re-simulated, until all of them (and their repetitions) are done. Only the
+  // results of the last repetition are kept (so that no result is written by two workers at once).
+  std::vector<ReplayResult> results(replays.size());
+  std::vector<unsigned long long> workerTiles(threadCnt, 0);
+  std::vector<std::exception_ptr> workerErrors(threadCnt);
+  std::atomic<std::size_t> nextJob{0};
+  const std::size_t jobCnt = replays.size() * repeatCnt;
+  auto work = [&](const unsigned int workerIdx) {
+    try {
+      for (std::size_t job = nextJob++; job < jobCnt; job = nextJob++) {
+        const std::size_t idx = job % replays.size();
+        ReplayPlayer player(replays[idx]);
+        while (player.Step()) {}
+        if (job / replays.size() == repeatCnt - 1) {
+          results[idx] = ReplayResult{player.GetScore(), player.GetTileCnt(), player.GetEndCause()};
+        }
+        workerTiles[workerIdx] += player.GetTileCnt();
+
+#ifdef SNAKE_INSTRUMENTATION
+        // In instrumentation builds, re-simulate the replay once more, now that the player's buffers have grown, to check
+        // that stepping through the World and Snake rules never allocates.
+        player.Restart();
+        ALLOC_BUDGET(stepBudget, "ReplayPlayer::Step", 0);
+        while (player.Step()) {}
+        ALLOC_BUDGET_CHECK(stepBudget);
+#endif
+      }
+    } catch(...) {
+      // Hand the error over to the main thread, and stop claiming replays.
+      workerErrors[workerIdx] = std::current_exception();
+      nextJob = jobCnt;
+    }
+  };
+
+  const Clock::time_point start = Clock::now();
+  std::vector<std::thread> workers;
+  for (unsigned int i = 0; i < threadCnt; i++) workers.emplace_back(work, i);
+  for (std::thread& worker : workers) worker.join();
+  const double elapsedS = std::max(std::chrono::duration<double>(Clock::now() - start).count(), 1e-9);
+  for (const std::exception_ptr& error : workerErrors) {
+    if (error) std::rethrow_exception(error);
+  }
+
+  // Report the mismatches.
+  unsigned long mismatchCnt = 0;
+  for (std::size_t i = 0; i < replays.size(); i++) {
+    const Replay& replay = replays[i];
+    const ReplayResult& result = results[i];
+    if (result.score == replay.GetScore() && result.tileCnt == replay.GetTileCnt() && result.endCause == replay.GetEndCause()) {
+      continue;
+    }
+    mismatchCnt++;
+    std::cout << "MISMATCH " << paths[i] << ": score " << result.score << " (recorded " << replay.GetScore() << "), steps "
+              << result.tileCnt << " (recorded " << replay.GetTileCnt() << "), end " << Replay::GetEndCauseName(result.endCause)
+              << " (recorded " << Replay::GetEndCauseName(replay.GetEndCause()) << ")" << std::endl;
+  }
+
+  // Report the throughput.
+  unsigned long long tiles = 0;
+  for (const unsigned long long cnt : workerTiles) tiles += cnt;
+  std::cout << "Re-simulated " << jobCnt << " replays (" << replays.size() << " x " << repeatCnt << ") with " << threadCnt
+            << " threads in " << std::fixed << std::setprecision(3) << elapsedS << " s: "
+            << std::setprecision(0) << jobCnt / elapsedS << " replays/sec, " << tiles / elapsedS << " steps/sec." << std::endl;
+  std::cout << ((mismatchCnt == 0)? "All replays match their recordings." : std::to_string(mismatchCnt) + " replays mismatch.")
+            << std::endl;
+  PROFILE_DUMP(std::cout);
+  return mismatchCnt;
+}
+
+int main(int argc, char **argv) {
+  try {
+    unsigned int threadCnt = std::max(std::thread::hardware_concurrency(), 1u);
+    unsigned int repeatCnt = 1;
+    std::vector<std::string> paths;
+    for (int i = 1; i < argc; i++) {
+      const std::string arg{argv[i]};
+      if (arg == "--generate" && i + 2 < argc) {
+        const unsigned long count = ParseCount(argv[i + 1]);
+        const unsigned long gridSideLen = (i + 3 < argc)? ParseCount(argv[i + 3]) : GRID_SIDE_LENGTH;
+        if (gridSideLen < GRID_MIN_SIDE_LENGTH || gridSideLen > GRID_MAX_SIDE_LENGTH) {
+          throw std::runtime_error("Invalid grid side length (expected an integer from " + std::to_string(GRID_MIN_SIDE_LENGTH)
+                                    + " to " + std::to_string(GRID_MAX_SIDE_LENGTH) + ").");
+        }
+        GenerateReplays(count, argv[i + 2], (unsigned int) gridSideLen);
+        return 0;
+      } else if (arg == "--threads" && i + 1 < argc) {
+        threadCnt = std::max((unsigned int) ParseCount(argv[++i]), 1u);
+      } else if (arg == "--repeat" && i + 1 < argc) {
+        repeatCnt = std::max((unsigned int) ParseCount(argv[++i]), 1u);
+      } else if (arg.compare(0, 2, "--") == 0) {
+        PrintUsage();
+        return -1;
+      } else {
+        paths.push_back(arg);
+      }
+    }
+
+    if (paths.empty()) {
+      PrintUsage();
+      return -1;
+    }
+    return (RunReplays(paths, threadCnt, repeatCnt) == 0)? 0 : 1;
+
+  } catch(const std::exception& e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return -1;
+  }
+}
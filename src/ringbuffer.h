@@ -0,0 +1,204 @@
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+
+/**
+ *  \brief Fixed-capacity double-ended ring buffer, with storage preallocated at construction.
+ * The capacity is rounded up to a power of two, so that wrapping an index around the buffer end is a single bitwise AND.
+ * Elements are stored contiguously (in at most two segments), and no memory is allocated after construction.
+ */
+template<typename T>
+class RingBuffer {
+ public:
+  /**
+   *  \brief Read-only iterator over the buffer elements, from the front to the back element.
+   */
+  class ConstIterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T*;
+    using reference = const T&;
+
+    /**
+     *  \brief Constructor of the iterator.
+     *  \param buffer The ring buffer being iterated.
+     *  \param index Index of the pointed element, relative to the buffer front.
+     */
+    ConstIterator(const RingBuffer& buffer, const std::size_t index) : buffer(&buffer), index(index) {}
+
+    reference operator*() const { return (*buffer)[index]; }
+    pointer operator->() const { return &(*buffer)[index]; }
+    ConstIterator& operator++() { index++; return *this; }
+    ConstIterator operator++(int) { ConstIterator prior = *this; index++; return prior; }
+    bool operator==(const ConstIterator& other) const { return index == other.index && buffer == other.buffer; }
+    bool operator!=(const ConstIterator& other) const { return !(*this == other); }
+
+   private:
+    /**
+     *  \brief The ring buffer being iterated.
+     */
+    const RingBuffer* buffer;
+
+    /**
+     *  \brief Index of the pointed element, relative to the buffer front.
+     */
+    std::size_t index;
+  };
+
+  /**
+   *  \brief Constructor of the ring buffer. All the storage is allocated here.
+   *  \param minCapacity Minimum number of elements the buffer shall be able to hold. The actual capacity is the smallest
+   * power of two greater than or equal to it.
+   */
+  RingBuffer(const std::size_t minCapacity) : buffer(RoundUpPow2(minCapacity)), mask(buffer.size() - 1) {}
+
+  /**
+   *  \brief Inserts an element before the current front element.
+   * If the buffer is already full, a runtime exception is thrown.
+   *  \param element The element to be inserted.
+   */
+  void PushFront(const T& element) {
+    if (count == buffer.size()) throw std::runtime_error("Ring buffer capacity exceeded.");
+    head = (head - 1) & mask;
+    buffer[head] = element;
+    count++;
+  }
+
+  /**
+   *  \brief Inserts an element after the current back element.
+   * If the buffer is already full, a runtime exception is thrown.
+   *  \param element The element to be inserted.
+   */
+  void PushBack(const T& element) {
+    if (count == buffer.size()) throw std::runtime_error("Ring buffer capacity exceeded.");
+    buffer[(head + count) & mask] = element;
+    count++;
+  }
+
+  /**
+   *  \brief Removes the front element. Does nothing if the buffer is empty.
+   */
+  void PopFront() {
+    if (count == 0) return;
+    head = (head + 1) & mask;
+    count--;
+  }
+
+  /**
+   *  \brief Removes the back element. Does nothing if the buffer is empty.
+   */
+  void PopBack() {
+    if (count > 0) count--;
+  }
+
+  /**
+   *  \brief Removes all elements, keeping the allocated storage.
+   */
+  void Clear() {
+    head = 0;
+    count = 0;
+  }
+
+  /**
+   *  \brief Returns the element at a given position, counted from the front. No bounds check is done.
+   *  \param index Position of the element, where 0 is the front element.
+   *  \return Const reference to the element.
+   */
+  const T& operator[](const std::size_t index) const { return buffer[(head + index) & mask]; }
+
+  /**
+   *  \brief Returns the front element. The buffer must not be empty.
+   *  \return Const reference to the front element.
+   */
+  const T& Front() const { return buffer[head]; }
+
+  /**
+   *  \brief Returns the back element. The buffer must not be empty.
+   *  \return Const reference to the back element.
+   */
+  const T& Back() const { return buffer[(head + count - 1) & mask]; }
+
+  /**
+   *  \brief Returns the number of elements currently stored.
+   *  \return Element count.
+   */
+  std::size_t Size() const { return count; }
+
+  /**
+   *  \brief Returns the maximum number of elements the buffer can hold.
+   *  \return Buffer capacity (always a power of two).
+   */
+  std::size_t Capacity() const { return buffer.size(); }
+
+  /**
+   *  \brief Indicates if the buffer holds no elements.
+   *  \return True, if the buffer is empty; false, otherwise.
+   */
+  bool Empty() const { return count == 0; }
+
+  /**
+   *  \brief Returns the first contiguous segment of elements, starting at the front element.
+   * Together with GetSecondSegment, allows linear (cache-friendly) traversal of the stored elements.
+   *  \param length Output parameter set with the number of elements in the segment.
+   *  \return Pointer to the front element.
+   */
+  const T* GetFirstSegment(std::size_t& length) const {
+    length = std::min(count, buffer.size() - head);
+    return buffer.data() + head;
+  }
+
+  /**
+   *  \brief Returns the second contiguous segment of elements (i.e. the elements wrapped around the storage end), which
+   * follows the first segment.
+   *  \param length Output parameter set with the number of elements in the segment (0 if the elements don't wrap around).
+   *  \return Pointer to the storage start.
+   */
+  const T* GetSecondSegment(std::size_t& length) const {
+    length = count - std::min(count, buffer.size() - head);
+    return buffer.data();
+  }
+
+  ConstIterator begin() const { return ConstIterator(*this, 0); }
+  ConstIterator end() const { return ConstIterator(*this, count); }
+
+ private:
+  /**
+   *  \brief Returns the smallest power of two greater than or equal to the input (and at least 1).
+   *  \param value The value to be rounded up.
+   *  \return The rounded value.
+   */
+  static std::size_t RoundUpPow2(const std::size_t value) {
+    std::size_t result = 1;
+    while (result < value) result <<= 1;
+    return result;
+  }
+
+  /**
+   *  \brief Preallocated element storage, whose size is a power of two.
+   */
+  std::vector<T> buffer;
+
+  /**
+   *  \brief Bit mask used to wrap indexes around the storage size.
+   */
+  std::size_t mask;
+
+  /**
+   *  \brief Storage index of the front element.
+   */
+  std::size_t head{0};
+
+  /**
+   *  \brief Number of elements currently stored.
+   */
+  std::size_t count{0};
+};
+
+#endif
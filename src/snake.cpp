@@ -5,72 +5,119 @@
 #include <Eigen/Dense>
 #include "clip.h"
 #include "config.h"
+#include "profiler.h"
 
 using Eigen::VectorXf; // Column vector
 
 Snake::Snake(const SDL_Point& startPosition, World& world) 
-  : startPosition{startPosition},
+  : positionQueue((std::size_t) world.GetGridSideLen() * world.GetGridSideLen()),
+    turnQueue(SNAKE_TURN_QUEUE_LEN),
+    startPosition{startPosition},
+    visitedFlags((std::size_t) world.GetGridSideLen() * world.GetGridSideLen(), false),
     world{world},
     mlp(SNAKE_STIMULI_LEN, SNAKE_MLP_LAYERS_SIZES),
-    genalg(mlp.GetWeightsCount(), GA_POPULATION_SIZE, GA_SURVIVORS_CNT, GA_MUTATION_RATE) {
+    genalg(std::make_shared<GenAlg>(mlp.GetWeightsCount(), GA_POPULATION_SIZE, GA_SURVIVORS_CNT, GA_MUTATION_RATE)) {
+  this->Init();
+}
+
+Snake::Snake(const SDL_Point& startPosition, World& world, std::shared_ptr<GenAlg> genalg) 
+  : positionQueue((std::size_t) world.GetGridSideLen() * world.GetGridSideLen()),
+    turnQueue(SNAKE_TURN_QUEUE_LEN),
+    startPosition{startPosition},
+    visitedFlags((std::size_t) world.GetGridSideLen() * world.GetGridSideLen(), false),
+    world{world},
+    mlp(SNAKE_STIMULI_LEN, SNAKE_MLP_LAYERS_SIZES),
+    genalg(genalg) {
   this->Init();
 }
 
 void Snake::Init() {
+  this->InitState();
+
+  // In auto mode, set MLP weights as the ones from the current individual in Genetic Algorithm population. In manual mode
+  // the MLP isn't used, and the genetic algorithm is left untouched (it may be trained by background workers meanwhile).
+  if (automode) this->mlp.SetWeights(genalg->GetCurIndividual());
+}
+
+void Snake::Init(const VectorXf& chromosome) {
+  this->InitState();
+  this->mlp.SetWeights(chromosome);
+}
+
+void Snake::Init(const std::vector<SDL_Point>& positions, const Direction2D direction) {
+  this->InitState();
+
+  // Replace the starting head with the given body, pushed from the tail to the head, and face the given direction.
+  // Obs.: the snake is assumed to have just crossed into its head tile, with no sub-tile progress.
+  world.SetElement(GetHeadPosition(), World::Element::None);
+  this->positionQueue.Clear();
+  for (auto position = positions.rbegin(); position != positions.rend(); ++position) PushNewSnakeHeadPos(*position);
+  this->direction = direction;
+  this->UpdateForbiddenDir();
+  this->tarHeadPos = Coords2D{GetHeadPosition(), 0};
+
+  // The visited tiles restart from the given head one.
+  this->RestartVisitedTiles();
+}
+
+void Snake::InitState() {
+  // Previous snapshots don't apply to the re-initialized snake, and neither do the covered positions.
+  this->ReleaseSnapshots();
+  this->coveredPositions.clear();
+
   // Initialize all snake object parameters.
   this->alive = true;
+  this->deathCause = DeathCause::None;
+  this->stepCnt = 0;
+  this->initTime = std::chrono::steady_clock::now();
   this->event = Event::SameTile;
   this->action = Action::MoveFwd;
   this->direction = Direction2D::Up;
   this->forbiddenDir = Direction2D::Down;
 
-  this->tarHeadPos = Coords2D(startPosition);
-  this->positionQueue.clear();
-  this->positionQueue.push_front(tarHeadPos);
+  this->tarHeadPos = Coords2D{startPosition, 0};
+  this->positionQueue.Clear();
+  this->turnQueue.Clear();
+  this->positionQueue.PushFront(tarHeadPos.tile);
 
   // Initialize snake head tile in world.
   this->world.SetElement(this->GetHeadPosition(), World::Element::AliveSnakeHead);
 
-  // Set MLP weights as the ones from the current individual in Genetic Algorithm population.
-  this->mlp.SetWeights(genalg.GetCurIndividual());
+  // Restart the visited tiles from the starting one.
+  this->RestartVisitedTiles();
+}
+
+void Snake::RestartVisitedTiles() {
+  for (const std::size_t cell : visitedCells) visitedFlags[cell] = false;
+  this->visitedCells.clear();
+  this->VisitHeadTile();
 }
 
-void Snake::ProcessUserCommand(const Controller::UserCommand command) {
-  if(command == Controller::UserCommand::ToggleAutoMode) ToggleAutoMode();
+void Snake::VisitHeadTile() {
+  const std::size_t cell = (std::size_t) GetHeadPosition().y * world.GetGridSideLen() + GetHeadPosition().x;
+  if (!visitedFlags[cell]) {
+    visitedFlags[cell] = true;
+    visitedCells.push_back(cell);
+  }
+}
+
+unsigned long Snake::GetLifetimeUs() const {
+  const std::chrono::steady_clock::time_point end = (alive)? std::chrono::steady_clock::now() : deathTime;
+  return (unsigned long) std::chrono::duration_cast<std::chrono::microseconds>(end - initTime).count();
+}
+
+void Snake::ProcessUserCommand(const Controller::TimedCommand& command) {
+  if(command.command == Controller::UserCommand::ToggleAutoMode) ToggleAutoMode();
   else if(!automode) {
     // If auto mode is on, only the auto mode toggling command is available, and all other commands are ignored.
-    // Else, check which command was received.
-    switch(command) {
+    // Else, queue any direction command, to be taken at one of the next tile crossings. If the queue is full, the latest 
+    // command is ignored, so the turns already queued keep their order.
+    switch(command.command) {
       case Controller::UserCommand::GoUp:
-        if (forbiddenDir != Direction2D::Up) {
-          // The command is only considered if the requested direction is different from the one pointing to the first snake body part.
-          // This is done to avoid having the snake die by colliding with it's first body part while the head is still in the same 
-          // grid tile, in case the player change directions too quickly.
-          if (direction == Direction2D::Left) Act(Action::MoveRight);
-          else if (direction == Direction2D::Right) Act(Action::MoveLeft);
-          else Act(Action::MoveFwd);
-        }
-        break;
       case Controller::UserCommand::GoDown:
-        if (forbiddenDir != Direction2D::Down) {
-          if (direction == Direction2D::Left) Act(Action::MoveLeft);
-          else if (direction == Direction2D::Right) Act(Action::MoveRight);
-          else Act(Action::MoveFwd);
-        }
-        break;
       case Controller::UserCommand::GoLeft:
-        if (forbiddenDir != Direction2D::Left) {
-          if (direction == Direction2D::Up) Act(Action::MoveLeft);
-          else if (direction == Direction2D::Down) Act(Action::MoveRight);
-          else Act(Action::MoveFwd);
-        }
-        break;
       case Controller::UserCommand::GoRight:
-        if (forbiddenDir != Direction2D::Right) {
-          if (direction == Direction2D::Up) Act(Action::MoveRight);
-          else if (direction == Direction2D::Down) Act(Action::MoveLeft);
-          else Act(Action::MoveFwd);
-        }
+        if (turnQueue.Size() < turnQueue.Capacity()) turnQueue.PushBack(command);
         break;
       default:
         // UserCommand::None (no command issued by user)
@@ -79,26 +126,66 @@ void Snake::ProcessUserCommand(const Controller::UserCommand command) {
   }
 }
 
-void Snake::Move() {
-  switch (direction) {
-    case Direction2D::Up:
-      tarHeadPos += FPoint{0,-speed};
-      break;
+void Snake::TakeQueuedTurn() {
+  while (!turnQueue.Empty()) {
+    const Controller::TimedCommand command = turnQueue.Front();
+    turnQueue.PopFront();
 
-    case Direction2D::Down:
-      tarHeadPos += FPoint{0,speed};
-      break;
+    // Get the requested direction.
+    Direction2D requested;
+    switch (command.command) {
+      case Controller::UserCommand::GoUp: requested = Direction2D::Up; break;
+      case Controller::UserCommand::GoDown: requested = Direction2D::Down; break;
+      case Controller::UserCommand::GoLeft: requested = Direction2D::Left; break;
+      default: requested = Direction2D::Right; break;
+    }
 
-    case Direction2D::Left:
-      tarHeadPos += FPoint{-speed,0};
-      break;
+    // The turn is only taken if the requested direction is perpendicular to the current one: moving forward is already
+    // the case, while the backward direction is forbidden, as it points to the first snake body part. Otherwise, the
+    // next queued turn is tried.
+    if (requested == direction || requested == forbiddenDir) continue;
+    Act((requested == GetLeftOf(direction))? Action::MoveLeft : Action::MoveRight);
 
-    case Direction2D::Right:
-      tarHeadPos += FPoint{speed,0};
-      break;
+    // Record the time from the key press until the turn.
+    const Uint32 latencyMs = CLPD_UINT_DIFF(SDL_GetTicks(), command.timestamp);
+    inputLatency.turnCnt++;
+    inputLatency.totalMs += latencyMs;
+    inputLatency.maxMs = std::max(inputLatency.maxMs, latencyMs);
+    return;
   }
 }
 
+void Snake::Move() {
+  // Advance the target head position's sub-tile progress in the current direction. Crossing into a new tile is detected
+  // by the caller through the comparison between the target and actual head positions.
+  AdvanceCoords(tarHeadPos, direction, speed, SNAKE_TICKS_PER_TILE);
+}
+
+void Snake::Update() {
+  // Move the snake in its current direction.
+  Move();
+
+  // Check if snake head is about to move to a new tile.
+  if (GetTargetHeadPosition() == GetHeadPosition()) {
+    // Snake head is still in the same world grid tile.
+    SetEvent(Event::SameTile);
+    return;
+  }
+
+  // Checks the new tile content and raises appropriate event (e.g. eating, collision, etc.)
+  EnterTargetTile(true);
+
+  // Keep the round statistics (only for actual moves, unlike the tiles entered by the lookahead search).
+  stepCnt++;
+  if (alive) VisitHeadTile();
+  else deathTime = std::chrono::steady_clock::now();
+
+  // If the snake is on automatic mode, call its decision model in order to define the next action/direction.
+  // Otherwise, take the player's next queued turn, if any.
+  if (alive && automode) DefineAction();
+  else if (alive) TakeQueuedTurn();
+}
+
 void Snake::SetEvent(const Event event) {
   this->event = event;
 
@@ -114,14 +201,14 @@ void Snake::SetEvent(const Event event) {
       // Remove the previous tail position from the world grid, as the snake didn't grow.
       PopSnakeTailPos();
       // Set the current head position as the target one.
-      PushNewSnakeHeadPos(tarHeadPos);
+      PushNewSnakeHeadPos(tarHeadPos.tile);
       // Set opposite to current direction as forbidden so that the snake cannot move to the same tile of its
       // first body part.
       UpdateForbiddenDir();
       break;
     case Event::Ate:
       // Set the current head position as the target one.
-      PushNewSnakeHeadPos(tarHeadPos);
+      PushNewSnakeHeadPos(tarHeadPos.tile);
       // Set opposite to current direction as forbidden so that the snake cannot move to the same tile of its
       // first body part.
       UpdateForbiddenDir();
@@ -134,6 +221,77 @@ void Snake::SetEvent(const Event event) {
 }
 
 void Snake::DefineAction() {
+  PROFILE_SCOPE(DefineAction);
+  if (lookahead) Act(SearchAction());
+  else Act(SelectAction(GetModelOutput()));
+}
+
+void Snake::StoreState(std::ofstream& file) const {
+  // Write the mlp configuration and genetic algorithm state.
+  mlp.StoreConfig(file);
+  genalg->StoreState(file);
+}
+
+void Snake::LoadState(std::ifstream& file) {
+  mlp.LoadConfig(file);
+  genalg->LoadState(file);
+
+  // Reinitialize snake.
+  this->Init();
+}
+
+void Snake::Act(const Action input) {
+  action = input;
+  if(action == Action::MoveFwd) {
+    // Do nothing
+  } else {
+    if(action == Action::MoveLeft) {
+      direction = GetLeftOf(direction);
+    } else {
+      // Action::MoveRight
+      direction = GetRightOf(direction);
+    }
+  }
+}
+
+void Snake::EnterTargetTile(const bool trackLoops) {
+  const SDL_Point target = GetTargetHeadPosition();
+
+  if (world.IsObstacle(target)) {
+    deathCause = (world.GetElement(target) == World::Element::Wall)? DeathCause::Wall : DeathCause::Body;
+    SetEvent(Event::Killed);
+
+  } else if (world.GetElement(target) == World::Element::Food) {
+    SetEvent(Event::Ate);
+
+    // Everytime the snake eats, if in automode, empty the covered grid positions.
+    if (automode && trackLoops) coveredPositions.clear();
+
+    // Now that the food has been eaten, make new food appear in a free grid tile.
+    // If a new food cannot be placed, the game has been won (which is checked by the game through World::HasFood).
+    world.GrowFood(world.GetFoodIndexAt(target));
+
+  } else {
+    // If the snake hasn't collided or eaten, just move it to the new tile.
+    SetEvent(Event::NewTile);
+
+    // If in automode, the new tile gets looked up for in the covered position+direction container.
+    if (automode && trackLoops) {
+      auto searchResult = coveredPositions.find(&world.GetElementRef(target));
+      if (searchResult != coveredPositions.end() && searchResult->second == direction) {
+        // If the position is present in the covered positions list, and the direction from which it was entered is the
+        // same as current one, kill the snake and end current game round to prevent an endless game loop.
+        deathCause = DeathCause::Loop;
+        SetEvent(Event::Killed);
+      } else {
+        // Otherwise, add the position to the container or update it with a new mapped value of current direction.
+        coveredPositions[&world.GetElementRef(target)] = direction;
+      }
+    }
+  }
+}
+
+VectorXf Snake::GetModelOutput() {
   /**
    * Build MLP input.
    * Input vector is composed of:
@@ -144,58 +302,128 @@ void Snake::DefineAction() {
    * - vertical distance to the food from the front side of the head. 
    */
   VectorXf input(SNAKE_STIMULI_LEN);
-  input[0] = GetDist2Obstacle(GetHeadPosition(), GetLeftOf(this->direction));
-  input[1] = GetDist2Obstacle(GetHeadPosition(), this->direction);
-  input[2] = GetDist2Obstacle(GetHeadPosition(), GetRightOf(this->direction));
-  SDL_Point versor2Food = GetVersor(GetHeadPosition(), world.GetFoodPosition(), this->direction);
+  unsigned int distances[4];
+  GetDist2Obstacles(distances);
+  input[0] = distances[(int) GetLeftOf(this->direction)];
+  input[1] = distances[(int) this->direction];
+  input[2] = distances[(int) GetRightOf(this->direction)];
+  SDL_Point versor2Food = GetVersor(GetHeadPosition(), world.GetFoodPosition(foodIdx), this->direction);
   input[3] = versor2Food.x;
   input[4] = versor2Food.y;
 
   // Run MLP and get output vector.
-  VectorXf output = mlp.GetOutput(input);
+  return mlp.GetOutput(input);
+}
 
+Snake::Action Snake::SelectAction(const VectorXf& output) {
   // Change or maintain direction depending on which output layer neuron presented the highest activation.
   // If neuron 0, move left; else if neuron 1, maintain direction; else if neuron 2, move right.
   if (output[0] > output[1]) {
-    if (output[0] > output[2]) Act(Action::MoveLeft);
-    else Act(Action::MoveRight);
+    if (output[0] > output[2]) return Action::MoveLeft;
+    else return Action::MoveRight;
   } else {
-    if (output[2] > output[1]) Act(Action::MoveRight);
-    else Act(Action::MoveFwd);
+    if (output[2] > output[1]) return Action::MoveRight;
+    else return Action::MoveFwd;
   }
 }
 
-void Snake::StoreState(std::ofstream& file) const {
-  // Write the mlp configuration and genetic algorithm state.
-  mlp.StoreConfig(file);
-  genalg.StoreState(file);
-}
+Snake::Action Snake::SearchAction() {
+  // The MLP decision at the current tile is the fallback, in case no action can avoid death.
+  Action bestAction = SelectAction(GetModelOutput());
 
-void Snake::LoadState(std::ifstream& file) {
-  mlp.LoadConfig(file);
-  genalg.LoadState(file);
+  // Initialize the search budget counters.
+  searchNodeCnt = 0;
+  if (searchBudget.maxTimeUs > 0) {
+    searchDeadline = std::chrono::steady_clock::now() + std::chrono::microseconds(searchBudget.maxTimeUs);
+  } else searchDeadline = std::chrono::steady_clock::time_point::max();
 
-  // Reinitialize snake.
-  this->Init();
-}
+  // Snapshots of the current state, restored after each explored branch.
+  // If no snapshot was open before the search, they are released at the end of it.
+  const bool releaseWorld = !world.HasSnapshots();
+  const bool releaseSnake = !journaling;
+  const World::Snapshot worldSnapshot = world.TakeSnapshot();
+  const Snapshot snakeSnapshot = TakeSnapshot();
 
-void Snake::Act(const Action input) {
-  action = input;
-  if(action == Action::MoveFwd) {
-    // Do nothing
-  } else {
-    if(action == Action::MoveLeft) {
-      direction = GetLeftOf(direction);
-    } else {
-      // Action::MoveRight
-      direction = GetRightOf(direction);
+  // Iteratively deepen the search tree, so that the result of the deepest fully searched level is available when
+  // the budget runs out.
+  bool withinBudget = true;
+  for (unsigned int depth = 0; depth < SNAKE_SEARCH_MAX_DEPTH && withinBudget; depth++) {
+    float levelBestScore = -INFINITY;
+    Action levelBestAction = bestAction;
+
+    for (const Action input : {Action::MoveFwd, Action::MoveLeft, Action::MoveRight}) {
+      float score = ExploreAction(input, depth, withinBudget);
+      world.RestoreSnapshot(worldSnapshot);
+      this->RestoreSnapshot(snakeSnapshot);
+      if (!withinBudget) break;
+
+      if (score > levelBestScore) {
+        levelBestScore = score;
+        levelBestAction = input;
+      }
     }
+
+    // Only use the level result if it was fully searched and at least one action avoids death.
+    // If all actions lead to certain death at this depth, deeper levels won't find a way out either.
+    if (!withinBudget || levelBestScore == -INFINITY) break;
+    bestAction = levelBestAction;
   }
+
+  if (releaseWorld) world.ReleaseSnapshots();
+  if (releaseSnake) this->ReleaseSnapshots();
+
+  return bestAction;
+}
+
+float Snake::ExploreAction(const Action input, const unsigned int depth, bool& withinBudget) {
+  // Check the search budget before expanding a new node.
+  searchNodeCnt++;
+  if ((searchBudget.maxNodes > 0 && searchNodeCnt > searchBudget.maxNodes) 
+      || std::chrono::steady_clock::now() > searchDeadline) {
+    withinBudget = false;
+    return -INFINITY;
+  }
+
+  // Act and move the snake head straight to the next tile.
+  Act(input);
+  tarHeadPos = Coords2D{GetAdjPosition(GetHeadPosition(), direction), 0};
+  const unsigned int targetFoodIdx = world.GetFoodIndexAt(tarHeadPos.tile);
+  EnterTargetTile(false);
+
+  // Prune branches leading to the snake's death.
+  if (!alive) return -INFINITY;
+
+  // Reward eating food. If no new food could be placed, the game is won and the branch ends here.
+  float reward = (event == Event::Ate)? SNAKE_SEARCH_FOOD_REWARD : 0.0f;
+  if (event == Event::Ate && !world.HasFood(targetFoodIdx)) return reward;
+
+  // Score the tree leaves with the MLP highest output activation.
+  if (depth == 0) return reward + GetModelOutput().maxCoeff();
+
+  // Otherwise, explore the next actions from the current state.
+  const World::Snapshot worldSnapshot = world.TakeSnapshot();
+  const Snapshot snakeSnapshot = TakeSnapshot();
+  float bestScore = -INFINITY;
+  for (const Action next : {Action::MoveFwd, Action::MoveLeft, Action::MoveRight}) {
+    float score = ExploreAction(next, depth - 1, withinBudget);
+    world.RestoreSnapshot(worldSnapshot);
+    this->RestoreSnapshot(snakeSnapshot);
+    if (!withinBudget) return -INFINITY;
+    bestScore = std::max(bestScore, score);
+  }
+
+  // If all following actions lead to death, so does this one.
+  return (bestScore == -INFINITY)? bestScore : reward + bestScore;
+}
+
+void Snake::RemoveFromWorld() {
+  for (const SDL_Point& position : positionQueue) world.SetElement(position, World::Element::None);
 }
 
 void Snake::PopSnakeTailPos() {
   world.SetElement(GetTailPosition(), World::Element::None);
-  positionQueue.pop_back(); 
+  if (journaling) journal.push_back({false, GetTailPosition()});
+  positionQueue.PopBack();
 }
 
 void Snake::PushNewSnakeHeadPos(const SDL_Point& head) {
@@ -204,12 +432,79 @@ void Snake::PushNewSnakeHeadPos(const SDL_Point& head) {
     // update the previous head position to contain a snake body part.
     world.SetElement(GetHeadPosition(), World::Element::SnakeBody);
   }
-  positionQueue.push_front(head); 
+  positionQueue.PushFront(head);
+  if (journaling) journal.push_back({true, head});
   world.SetElement(head, World::Element::AliveSnakeHead);
 }
 
-unsigned int Snake::GetDist2Obstacle(const SDL_Point& reference, const Direction2D direction) {
+Snake::Snapshot Snake::TakeSnapshot() {
+  journaling = true;
+  return Snapshot{journal.size(), direction, forbiddenDir, tarHeadPos, alive, action, event, deathCause};
+}
+
+void Snake::RestoreSnapshot(const Snapshot& snapshot) {
+  // Undo the body changes from the latest to the oldest one, until the journal is back to the snapshot length.
+  while (journal.size() > snapshot.journalSize) {
+    const JournalEntry& entry = journal.back();
+    if (entry.pushedHead) positionQueue.PopFront();
+    else positionQueue.PushBack(entry.poppedTail);
+    journal.pop_back();
+  }
+
+  // Restore the remaining snake state.
+  direction = snapshot.direction;
+  forbiddenDir = snapshot.forbiddenDir;
+  tarHeadPos = snapshot.tarHeadPos;
+  alive = snapshot.alive;
+  action = snapshot.action;
+  event = snapshot.event;
+  deathCause = snapshot.deathCause;
+}
+
+void Snake::ReleaseSnapshots() {
+  journaling = false;
+  journal.clear();
+}
+
+void Snake::GetDist2Obstacles(unsigned int (&distances)[4]) const {
+  const SDL_Point head = GetHeadPosition();
+
+  // If other snakes share the world, their parts can't be told from the snake's own positions, so walk the grid instead.
+  if (world.GetSnakeCellCnt() != positionQueue.Size()) {
+    for (int i = 0; i < 4; i++) distances[i] = GetDist2Obstacle(head, (Direction2D) i);
+    return;
+  }
+
+  // Start from the distances to the walls, at the grid borders.
+  const int lastIdx = (int) world.GetGridSideLen() - 1;
+  unsigned int& up = distances[(int) Direction2D::Up];
+  unsigned int& right = distances[(int) Direction2D::Right];
+  unsigned int& down = distances[(int) Direction2D::Down];
+  unsigned int& left = distances[(int) Direction2D::Left];
+  up = head.y;
+  right = lastIdx - head.x;
+  down = lastIdx - head.y;
+  left = head.x;
+
+  // Then, bring them closer for each body part in the head's column or row (in a single pass over the body).
+  for (const SDL_Point& part : positionQueue) {
+    if (part.x == head.x) {
+      if (part.y < head.y) up = std::min<unsigned int>(up, head.y - part.y);
+      else if (part.y > head.y) down = std::min<unsigned int>(down, part.y - head.y);
+    } else if (part.y == head.y) {
+      if (part.x < head.x) left = std::min<unsigned int>(left, head.x - part.x);
+      else right = std::min<unsigned int>(right, part.x - head.x);
+    }
+  }
+}
+
+unsigned int Snake::GetDist2Obstacle(const SDL_Point& reference, const Direction2D direction) const {
+  // Walk along the direction until an obstacle is found (iteratively, so that long rays in large grids can't overflow the stack).
+  unsigned int distance = 1;
   SDL_Point adjPos = GetAdjPosition(reference, direction);
-  if (world.IsObstacle(adjPos)) return 1;
-  else return GetDist2Obstacle(adjPos, direction) + 1;
+  while (!world.IsObstacle(adjPos)) {
+    adjPos = GetAdjPosition(adjPos, direction);
+    distance++;
+  }
+  return distance;
 }
\ No newline at end of file
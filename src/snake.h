@@ -1,11 +1,17 @@
 #ifndef SNAKE_H
 #define SNAKE_H
 
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <unordered_map>
+
 #include "controller.h"
 #include "world.h"
 #include "coords2D.h"
 #include "genalg.h"
 #include "mlp.h"
+#include "ringbuffer.h"
 
 /**
  *  \brief Size of the vector input to the snake's MLP during auto (AI) mode.
@@ -34,6 +40,44 @@ class Snake {
    */
   enum class Action { MoveFwd, MoveLeft, MoveRight };
 
+  /**
+   *  \brief Snake death cause enum: none (i.e. still alive), collision with a wall, collision with a snake's head or body, or
+   * kill in an endless loop (in auto mode).
+   */
+  enum class DeathCause { None, Wall, Body, Loop };
+
+  /**
+   *  \brief Budget of the snake AI lookahead search, per decision. A zero value means the respective limit is unbounded.
+   */
+  struct SearchBudget {
+    /**
+     *  \brief Maximum number of search tree nodes to be expanded.
+     */
+    unsigned int maxNodes;
+
+    /**
+     *  \brief Maximum search time, in microseconds.
+     */
+    unsigned int maxTimeUs;
+  };
+
+  /**
+   *  \brief Lightweight snapshot of the snake state. Instead of copying the snake's body, it records the length of the snake's 
+   * journal of body changes at the time it was taken, so that restoring it only undoes the changes done since then.
+   * Obs.: the snake's tiles in the world grid are restored by the world's own snapshot, which shall be taken and restored
+   * together with this one.
+   */
+  struct Snapshot {
+    std::size_t journalSize;
+    Direction2D direction;
+    Direction2D forbiddenDir;
+    Coords2D tarHeadPos;
+    bool alive;
+    Action action;
+    Event event;
+    DeathCause deathCause;
+  };
+
   /**
    *  \brief Snake object constructor.
    *  \param startPosition The snake's starting position in the game grid.
@@ -42,21 +86,75 @@ class Snake {
   Snake(const SDL_Point& startPosition, World& world);
 
   /**
-   *  \brief Initializes the snake's parameters and world view.
+   *  \brief Snake object constructor, for a snake sharing the genetic algorithm of other snakes (e.g. in a shared world where
+   * several individuals of the same generation are evaluated at once).
+   *  \param startPosition The snake's starting position in the game grid.
+   *  \param world Reference to the game world, so that it also can be changed based on snake's events.
+   *  \param genalg The shared genetic algorithm.
+   */
+  Snake(const SDL_Point& startPosition, World& world, std::shared_ptr<GenAlg> genalg);
+
+  /**
+   *  \brief Initializes the snake's parameters and world view. In auto mode, the MLP weights are set to the ones of the
+   * genetic algorithm's current individual.
    */
   void Init();
 
+  /**
+   *  \brief Initializes the snake's parameters and world view, with the MLP weights of a specific individual (the genetic
+   * algorithm isn't accessed, so that several snakes may be initialized concurrently, e.g. by training worker threads).
+   *  \param chromosome The individual/chromosome whose weights shall be used.
+   */
+  void Init(const VectorXf& chromosome);
+
+  /**
+   *  \brief Initializes the snake's parameters and world view with a given body and direction, instead of the starting ones
+   * (e.g. to resume a recorded game round from a keyframe). The MLP weights are left untouched.
+   *  \param positions The snake's head and body parts positions, ordered from the head to the tail (at least the head).
+   *  \param direction The snake's current direction.
+   */
+  void Init(const std::vector<SDL_Point>& positions, const Direction2D direction);
+
+  /**
+   *  \brief Input latency statistics of the player's turns, i.e. the time from each turn key press until the snake actually
+   * turns.
+   */
+  struct InputLatency {
+    /**
+     *  \brief Number of turns taken.
+     */
+    unsigned int turnCnt{0};
+
+    /**
+     *  \brief Sum of the turns latencies, in milliseconds.
+     */
+    unsigned long totalMs{0};
+
+    /**
+     *  \brief Maximum turn latency, in milliseconds.
+     */
+    unsigned int maxMs{0};
+  };
+
   /**
    *  \brief Updates the snake internal state based on the user command.
-   *  \param command Latest command issued by the player.
+   * Direction commands are queued, and the snake takes one queued turn per grid tile crossing (see Update).
+   *  \param command Command issued by the player, with its timestamp.
    */
-  void ProcessUserCommand(const Controller::UserCommand command);
+  void ProcessUserCommand(const Controller::TimedCommand& command);
 
   /**
    *  \brief Moves the snake (following its current direction), by updating its head location in the world.
    */
   void Move();
 
+  /**
+   *  \brief Moves the snake and, in case its head enters a new tile, checks the tile content and sets the appropriate event 
+   * (e.g. eating, collision, etc.), growing a new food in the world if the previous one was eaten.
+   * In auto mode, also kills the snake if it's found to be in an endless loop, and defines its next action.
+   */
+  void Update();
+
   /**
    *  \brief Sets the latest snake event, resulting from its last action, and updates other internal parameters based on the event.
    *  \param event The event to be set.
@@ -65,9 +163,41 @@ class Snake {
 
   /**
    *  \brief Calculates the snake's AI model decision for the next snake action, based on the world state.
+   * If the lookahead search is on, the decision is taken by searching the possible actions a few tiles ahead, using the
+   * AI model as a heuristic (see SearchAction).
    */
   void DefineAction();
 
+  /**
+   *  \brief Makes the snake act, i.e. turn (or not) relative to its current direction.
+   *  \param input Target action.
+   */
+  void Act(const Action input);
+
+  /**
+   *  \brief Sets the snake mode to either auto (controlled by AI) or manual (controllable by the player).
+   *  \param automode True, for auto mode; false, for manual mode.
+   */
+  inline void SetAutoMode(const bool automode) { this->automode = automode; }
+
+  /**
+   *  \brief Toggles the AI lookahead search on and off.
+   */
+  inline void ToggleLookahead() { this->lookahead = !this->lookahead; }
+
+  /**
+   *  \brief Indicates if the AI lookahead search is on.
+   *  \return True, if the snake AI decisions use the lookahead search. False, if they're taken directly by the AI model.
+   */
+  bool IsLookaheadOn() const { return lookahead; }
+
+  /**
+   *  \brief Sets the budget of the AI lookahead search, per decision.
+   *  \param budget The search budget. Zero values mean the respective limits are unbounded (the search is then limited by
+   * its maximum depth only).
+   */
+  inline void SetSearchBudget(const SearchBudget& budget) { this->searchBudget = budget; }
+
   /**
    *  \brief Stores the configuration and state of the Snake (more specifically, its MLP and Genetic Algorithm) in an output file stream.
    *  \param file Output file stream to which the Snake parameters will be written.
@@ -93,6 +223,31 @@ class Snake {
    */
   Event GetEvent() const { return event; }
 
+  /**
+   *  \brief Returns the cause of the snake's death.
+   *  \return Death cause, or DeathCause::None if the snake is alive.
+   */
+  DeathCause GetDeathCause() const { return deathCause; }
+
+  /**
+   *  \brief Returns the number of grid tiles the snake entered since its initialization (including the one it died in, if any).
+   *  \return Number of steps, in tiles.
+   */
+  unsigned long GetStepCnt() const { return stepCnt; }
+
+  /**
+   *  \brief Returns the number of distinct grid tiles the snake's head visited since its initialization (including its
+   * starting tile).
+   *  \return Number of visited tiles.
+   */
+  unsigned int GetVisitedTileCnt() const { return (unsigned int) visitedCells.size(); }
+
+  /**
+   *  \brief Returns the wall time the snake lived since its initialization (or for as long as it has been alive).
+   *  \return Lifetime, in microseconds.
+   */
+  unsigned long GetLifetimeUs() const;
+
   /**
    *  \brief Returns the current snake direction.
    *  \return Current snake direction.
@@ -115,44 +270,73 @@ class Snake {
    *  \brief Returns the current snake size.
    *  \return Current snake size.
    */
-  int GetSize() const { return positionQueue.size(); }
+  int GetSize() const { return positionQueue.Size(); }
 
   /**
    *  \brief Returns the current position of the snake's tail in the game grid. In case the snake's size is 1, returns the head position.
    *  \return The discrete coordinates of the snake's tail in the game grid (i.e. from player's perspective).
    */
-  SDL_Point GetTailPosition() const { return positionQueue.back(); }
+  SDL_Point GetTailPosition() const { return positionQueue.Back(); }
 
   /**
    *  \brief Returns the current position of the snake's head in the game grid.
    *  \return The discrete coordinates of the snake's head in the game grid (i.e. from player's perspective).
    */
-  SDL_Point GetHeadPosition() const { return positionQueue.front(); }
+  SDL_Point GetHeadPosition() const { return positionQueue.Front(); }
+
+  /**
+   *  \brief Returns the snake's head and body parts positions, ordered from the head to the tail.
+   *  \return Const reference to the snake's position ring buffer.
+   */
+  const RingBuffer<SDL_Point>& GetPositions() const { return positionQueue; }
 
   /**
    *  \brief Returns the current target position for the snake's head in the game grid. The actual head position may be different.
    *  \return The target coordinates of the snake's head in the game grid (i.e. from player's perspective).
    */
-  SDL_Point GetTargetHeadPosition() const { return tarHeadPos; }
+  SDL_Point GetTargetHeadPosition() const { return tarHeadPos.tile; }
+
+  /**
+   *  \brief Returns the input latency statistics of the player's turns taken since the latest reset.
+   *  \return Const reference to the input latency statistics.
+   */
+  const InputLatency& GetInputLatency() const { return inputLatency; }
+
+  /**
+   *  \brief Clears the input latency statistics.
+   */
+  inline void ResetInputLatency() { this->inputLatency = InputLatency(); }
+
+  /**
+   *  \brief Returns the snake head's progress towards the next grid tile in its current direction.
+   *  \return Number of sub-tile motion ticks already covered (see SNAKE_TICKS_PER_TILE).
+   */
+  unsigned int GetSubTileTicks() const { return tarHeadPos.ticks; }
+
+  /**
+   *  \brief Returns the snake speed.
+   *  \return Speed, in sub-tile motion ticks per update.
+   */
+  unsigned int GetSpeed() const { return speed; }
 
   /**
    *  \brief Returns the count of the Snake's genetic algorithm's generations.
    *  \return Unsigned int representing current generation number.
    */
-  unsigned int GetGenAlgGeneration() const { return genalg.GetGenerationCnt(); }
+  unsigned int GetGenAlgGeneration() const { return genalg->GetGenerationCnt(); }
 
   /**
    *  \brief Returns the count of already fitness-evaluated individuals in the current Snake's genetic algorithm generation.
    *  \return Unsigned int representing the index of the individual under fitness evaluation.
    */
-  unsigned int GetGenAlgIndividual() const { return genalg.GetIndividualCnt(); }
+  unsigned int GetGenAlgIndividual() const { return genalg->GetIndividualCnt(); }
 
   /**
    *  \brief Sets the fitness corresponding to the latest snake performance.
    *  \param fitness Value to be set as the fitness of the current individual in the snake's genetic algorithm, 
    * used to train/evolve the snake over time.
    */
-  inline void GradeFitness(const float& fitness) { this->genalg.GradeCurFitness(fitness); }
+  inline void GradeFitness(const float& fitness) { this->genalg->GradeCurFitness(fitness); }
 
   /**
    *  \brief Re-initializes the AI MLP parameters (e.g. number of layers and their sizes) to the default ones.
@@ -162,15 +346,114 @@ class Snake {
   /**
    *  \brief Resets the algorithm parameters values to the default ones and reinitialize the GA state.
    */
-  inline void ResetGenAlg() { this->genalg.Reset(); }
+  inline void ResetGenAlg() { this->genalg->Reset(); }
+
+  /**
+   *  \brief Returns the snake's genetic algorithm, so that it can be shared with other snakes.
+   *  \return Shared pointer to the genetic algorithm.
+   */
+  std::shared_ptr<GenAlg> GetGenAlg() const { return genalg; }
+
+  /**
+   *  \brief Sets the snake's MLP weights to the ones of a specific individual, instead of the genetic algorithm's current one.
+   *  \param chromosome The individual/chromosome whose weights shall be used.
+   */
+  inline void SetIndividual(const VectorXf& chromosome) { this->mlp.SetWeights(chromosome); }
+
+  /**
+   *  \brief Sets which of the world foods the snake targets (i.e. perceives in its AI model stimuli).
+   *  \param foodIdx Index of the food in the world.
+   */
+  inline void SetFoodIndex(const unsigned int foodIdx) { this->foodIdx = foodIdx; }
+
+  /**
+   *  \brief Removes the snake's head and body parts from the world grid, e.g. after its death in a shared world.
+   */
+  void RemoveFromWorld();
+
+  /**
+   *  \brief Takes a snapshot of the current snake state and starts journaling every subsequent change to its body, so that 
+   * the snapshot can later be restored in time proportional to the number of changes.
+   * Several snapshots can be taken and restored (any number of times) until ReleaseSnapshots is called.
+   *  \return The snapshot object.
+   */
+  Snapshot TakeSnapshot();
+
+  /**
+   *  \brief Restores the snake to the state it had when the input snapshot was taken. The snapshot must not have been released.
+   *  \param snapshot The snapshot to be restored.
+   */
+  void RestoreSnapshot(const Snapshot& snapshot);
+
+  /**
+   *  \brief Invalidates all taken snapshots, stopping the body changes journaling and discarding the journal.
+   */
+  void ReleaseSnapshots();
   
  private:
+  /**
+   *  \brief Initializes the snake's parameters and world view, except for its MLP weights.
+   */
+  void InitState();
 
   /**
-   *  \brief Makes the snake act.
-   *  \param input Target action.
+   *  \brief Records the snake's head tile as visited, unless it already was.
    */
-  void Act(const Action input);
+  void VisitHeadTile();
+
+  /**
+   *  \brief Clears the visited tiles, and records the snake's head tile as the first visited one.
+   */
+  void RestartVisitedTiles();
+
+  /**
+   *  \brief Checks the content of the tile the target head position points to, and sets the appropriate event.
+   *  \param trackLoops Indicates if, in auto mode, the covered positions shall be updated and checked for an endless loop 
+   * (which is not done while exploring hypothetical moves in the lookahead search).
+   */
+  void EnterTargetTile(const bool trackLoops);
+
+  /**
+   *  \brief Builds the AI model input stimuli from the current world state and runs the MLP.
+   *  \return The MLP output vector, with one activation per possible action (left, forward, right).
+   */
+  VectorXf GetModelOutput();
+
+  /**
+   *  \brief Returns the action corresponding to the MLP output neuron with the highest activation.
+   *  \param output The MLP output vector.
+   *  \return The selected action.
+   */
+  static Action SelectAction(const VectorXf& output);
+
+  /**
+   *  \brief Runs a depth-limited lookahead search over the snake's possible actions, within the search budget, and returns
+   * the best one. The search expands each action tile by tile (using world and snake snapshots to branch), prunes branches
+   * leading to certain death, rewards eaten food, and scores the tree leaves with the MLP highest output activation.
+   * The tree is iteratively deepened up to SNAKE_SEARCH_MAX_DEPTH, and the result of the deepest fully searched level is used.
+   * In case no action can avoid death, the MLP decision at the current tile is returned.
+   *  \return The selected action.
+   */
+  Action SearchAction();
+
+  /**
+   *  \brief Simulates an action, moving the snake to the next tile, and recursively explores the following actions.
+   * The caller is responsible for restoring the world and snake states afterwards.
+   *  \param input The action to be simulated.
+   *  \param depth Number of further tiles to be explored after the simulated one.
+   *  \param withinBudget Output flag, set to false if the search budget was exhausted (in which case the result is invalid).
+   *  \return The best score among the branch leaves, or minus infinity if all of them lead to the snake's death.
+   */
+  float ExploreAction(const Action input, const unsigned int depth, bool& withinBudget);
+
+  /**
+   *  \brief Entry of the body changes journal: either a new head pushed to the front of the position queue, or a tail 
+   * popped from its back (in which case the popped position is kept, so it can be pushed back on restoration).
+   */
+  struct JournalEntry {
+    bool pushedHead;
+    SDL_Point poppedTail;
+  };
 
   /**
    *  \brief Removes the last element from the snake's position queue (i.e. its previous tail position) and also updates the same tile
@@ -186,17 +469,34 @@ class Snake {
   void PushNewSnakeHeadPos(const SDL_Point& head);
 
   /**
-   *  \brief Calculates the distance from a reference point to the closest obstacle (wall or snake body part) in a specific direction.
+   *  \brief Calculates the distances from the snake's head to the closest obstacle (wall or snake part) in each direction.
+   * If the snake is alone in its world, the wall distances follow from the head coordinates (as the walls are only located
+   * at the grid borders), and the closest body parts are found among the snake's positions, so the cost depends on the
+   * snake's size rather than on the grid side. Otherwise (i.e. in a world shared with other snakes), the grid is walked
+   * along each direction.
+   *  \param distances Output distances, indexed by direction (see Direction2D).
+   */
+  void GetDist2Obstacles(unsigned int (&distances)[4]) const;
+
+  /**
+   *  \brief Calculates the distance from a reference point to the closest obstacle (wall or snake body part) in a specific
+   * direction, by walking the grid along the direction.
    *  \param reference The reference grid position.
    *  \param direction The direction being considered.
    *  \return The absolute distance from the reference point to the closest obstacle in the input direction.
    */
-  unsigned int GetDist2Obstacle(const SDL_Point& reference, const Direction2D direction);
+  unsigned int GetDist2Obstacle(const SDL_Point& reference, const Direction2D direction) const;
 
   /**
    *  \brief Toggles the snake mode between auto (controlled by AI) and manual (controllable by the player).
    */
-  inline void ToggleAutoMode() { this->automode = !this->automode; }
+  inline void ToggleAutoMode() { this->automode = !this->automode; this->turnQueue.Clear(); }
+
+  /**
+   *  \brief Takes the oldest queued player turn that is possible in the current direction (i.e. not forward nor backward),
+   * discarding any impossible one before it, and records its input latency.
+   */
+  void TakeQueuedTurn();
 
   /**
    *  \brief Sets the direction opposite to the current snake one to be forbidden - meaning the player cannot change the snake's
@@ -219,16 +519,37 @@ class Snake {
   Direction2D forbiddenDir{Direction2D::Down};
 
   /**
-   *  \brief Double-ended queue containing the snake's head and body parts coordinates in the world. The double-ended queue
-   * has constant complexity for push and pop operations at both queue ends, which makes it more efficient to be used here
-   * instead of a vector (which displays linear complexity for operations at its front).
+   *  \brief Ring buffer containing the snake's head and body parts coordinates in the world, from head to tail.
+   * As the snake can never be longer than the world grid area, the buffer is preallocated with that capacity at construction,
+   * so pushing a new head or popping the tail never allocates memory, even across game rounds.
    */
-  std::deque<SDL_Point> positionQueue;
+  RingBuffer<SDL_Point> positionQueue;
 
   /**
-   *  \brief The target position for the snake's head in the game grid. The actual head position may be different.
+   *  \brief Bounded queue of the player's direction commands not taken yet, from the oldest to the latest one.
    */
-  Coords2D tarHeadPos;
+  RingBuffer<Controller::TimedCommand> turnQueue;
+
+  /**
+   *  \brief Input latency statistics of the player's turns taken since the latest reset.
+   */
+  InputLatency inputLatency;
+
+  /**
+   *  \brief Journal of body changes done since the oldest unreleased snapshot, from the oldest to the latest change.
+   */
+  std::vector<JournalEntry> journal;
+
+  /**
+   *  \brief Indicates if body changes are being journaled (i.e. if there's any unreleased snapshot).
+   */
+  bool journaling{false};
+
+  /**
+   *  \brief The target position for the snake's head in the game grid, with integer sub-tile progress. 
+   * The actual head position may be different.
+   */
+  Coords2D tarHeadPos{{0,0}, 0};
 
   /**
    *  \brief The starting position for the snake's head in the game grid, used during re-initializations of the snake.
@@ -241,9 +562,9 @@ class Snake {
   bool alive{true};
 
   /**
-   *  \brief Current snake speed.
+   *  \brief Current snake speed, in sub-tile motion ticks per update (see SNAKE_TICKS_PER_TILE).
    */
-  const float speed{0.2f};
+  const unsigned int speed{1};
 
   /**
    *  \brief The latest snake action.
@@ -255,11 +576,70 @@ class Snake {
    */
   Event event{Event::SameTile};
 
+  /**
+   *  \brief The cause of the snake's death, if it's deceased.
+   */
+  DeathCause deathCause{DeathCause::None};
+
+  /**
+   *  \brief Number of grid tiles entered since the snake's initialization.
+   */
+  unsigned long stepCnt{0};
+
+  /**
+   *  \brief Indexes of the distinct grid cells visited by the snake's head since its initialization, and flags indicating
+   * which cells are listed (so that each one is listed once, and the flags are reset in time proportional to the visits).
+   */
+  std::vector<std::size_t> visitedCells;
+  std::vector<bool> visitedFlags;
+
+  /**
+   *  \brief Time of the snake's initialization, and of its death.
+   */
+  std::chrono::steady_clock::time_point initTime;
+  std::chrono::steady_clock::time_point deathTime;
+
   /**
    *  \brief True, if the snake is autonomous and controlled by CPU. False, if it's controllable by the player.
    */
   bool automode{false};
 
+  /**
+   *  \brief Indicates if the AI decisions use the lookahead search.
+   */
+  bool lookahead{false};
+
+  /**
+   *  \brief Budget of the AI lookahead search, per decision.
+   */
+  SearchBudget searchBudget{0, 0};
+
+  /**
+   *  \brief Number of tree nodes expanded by the ongoing lookahead search.
+   */
+  unsigned int searchNodeCnt{0};
+
+  /**
+   *  \brief Deadline of the ongoing lookahead search.
+   */
+  std::chrono::steady_clock::time_point searchDeadline;
+
+  /**
+   *  \brief Snake covered positions container.
+   * This container maps key values of an Element address (representing a position in the game grid
+   * the snake has covered) to a Direction2D representing the direction from which the snake entered
+   * the same grid position.
+   * This is used to identify the beginning of an endless loop of movement during auto (AI) mode, as
+   * the MLP will provide the same output decision for the rest of the game round.
+   * After the snake eats or a new game round starts, this container is emptied.
+   * Then, after every grid position+direction set, this gets added to the container if not there
+   * yet.
+   * Otherwise, if the same position+direction is identified to be present in the map already, the 
+   * snake is killed to end the game round as soon as possible, and thus accelerate the machine 
+   * learning algorithm for the snake AI.
+   */
+  std::unordered_map<World::Element*, Direction2D> coveredPositions;
+
   /**
    *  \brief Reference to the game world, so that it also can be changed based on snake's events.
    */
@@ -271,9 +651,14 @@ class Snake {
   MLP mlp;
 
   /**
-   *  \brief Genetic algorithm used to train the snake's MLP-based decision model over time.
+   *  \brief Genetic algorithm used to train the snake's MLP-based decision model over time. May be shared with other snakes.
+   */
+  std::shared_ptr<GenAlg> genalg;
+
+  /**
+   *  \brief Index of the world food targeted by the snake.
    */
-  GenAlg genalg;
+  unsigned int foodIdx{0};
 };
 
 #endif
\ No newline at end of file
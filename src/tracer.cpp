@@ -0,0 +1,122 @@
+#include "tracer.h"
+
+#ifdef SNAKE_INSTRUMENTATION
+
+#include <stdexcept>
+
+/**
+ *  \brief Minimum number of spans each thread's buffer can hold while waiting to be written (more spans are dropped).
+ */
+#define TRACE_BUFFER_CAPACITY 16384
+
+/**
+ *  \brief Interval between the writer thread's writes to the trace file, in milliseconds.
+ */
+#define TRACE_FLUSH_MS 20
+
+std::atomic<bool> Tracer::enabled{false};
+std::atomic<bool> Tracer::stopping{false};
+std::atomic<Tracer::ThreadBuffer*> Tracer::threadBuffersHead{nullptr};
+std::atomic<unsigned int> Tracer::threadCnt{0};
+std::chrono::steady_clock::time_point Tracer::startTime;
+std::FILE *Tracer::file{nullptr};
+unsigned long Tracer::eventCnt{0};
+std::thread Tracer::writer;
+
+Tracer::Span::Span(const char *name, const char *argName, const long argValue)
+  : name(name), argName(argName), argValue(argValue), active(Tracer::IsEnabled()) {
+  if (active) start = std::chrono::steady_clock::now();
+}
+
+void Tracer::Span::End() {
+  if (!active) return;
+  active = false;
+  if (!Tracer::IsEnabled()) return;
+
+  using std::chrono::nanoseconds;
+  const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+  const Event event{name, argName, argValue, std::chrono::duration_cast<nanoseconds>(start - startTime).count(),
+                    std::chrono::duration_cast<nanoseconds>(end - start).count()};
+  ThreadBuffer& buffer = GetThreadBuffer();
+  if (!buffer.queue.Push(event)) buffer.droppedCnt.fetch_add(1, std::memory_order_relaxed);
+}
+
+Tracer::ThreadBuffer::ThreadBuffer(const unsigned int tid) : queue(TRACE_BUFFER_CAPACITY), tid(tid) {}
+
+Tracer::ThreadBuffer& Tracer::GetThreadBuffer() {
+  thread_local ThreadBuffer *buffer = nullptr;
+  if (buffer == nullptr) {
+    buffer = new ThreadBuffer(++threadCnt);
+    buffer->next = threadBuffersHead.load(std::memory_order_relaxed);
+    while (!threadBuffersHead.compare_exchange_weak(buffer->next, buffer, std::memory_order_release,
+                                                    std::memory_order_relaxed)) {}
+  }
+  return *buffer;
+}
+
+void Tracer::SetThreadName(const char *name) {
+  // Threads are only given a buffer while tracing (so the threads started before the trace are left unnamed).
+  if (IsEnabled()) GetThreadBuffer().name.store(name, std::memory_order_relaxed);
+}
+
+void Tracer::Start(const std::string& path) {
+  if (file != nullptr) return;
+  file = std::fopen(path.c_str(), "w");
+  if (file == nullptr) throw std::runtime_error("Trace file \"" + path + "\" could not be opened.");
+  std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", file);
+  eventCnt = 0;
+
+  startTime = std::chrono::steady_clock::now();
+  stopping = false;
+  enabled.store(true, std::memory_order_release);
+  writer = std::thread(&Tracer::Write);
+}
+
+void Tracer::Stop() {
+  if (file == nullptr) return;
+  enabled.store(false, std::memory_order_release);
+  stopping = true;
+  writer.join();
+
+  // Name the threads' tracks (and report the spans dropped from each one, if any), then close the event array.
+  for (ThreadBuffer *buffer = threadBuffersHead.load(std::memory_order_acquire); buffer != nullptr; buffer = buffer->next) {
+    const char *name = buffer->name.load(std::memory_order_relaxed);
+    std::fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                 (eventCnt++ > 0)? ",\n" : "", buffer->tid, (name != nullptr)? name : "thread");
+    const unsigned long droppedCnt = buffer->droppedCnt.load(std::memory_order_relaxed);
+    if (droppedCnt > 0) {
+      std::fprintf(file, ",\n{\"name\":\"dropped_spans\",\"ph\":\"C\",\"ts\":0,\"pid\":1,\"tid\":%u,\"args\":{\"count\":%lu}}",
+                   buffer->tid, droppedCnt);
+    }
+  }
+  std::fputs("\n]}\n", file);
+  std::fclose(file);
+  file = nullptr;
+}
+
+void Tracer::Write() {
+  while (true) {
+    // Check for the stop request before draining the buffers, so the spans queued before it are all written.
+    const bool stop = stopping;
+    Drain();
+    if (stop) return;
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(TRACE_FLUSH_MS));
+  }
+}
+
+void Tracer::Drain() {
+  Event event;
+  for (ThreadBuffer *buffer = threadBuffersHead.load(std::memory_order_acquire); buffer != nullptr; buffer = buffer->next) {
+    while (buffer->queue.Pop(event)) {
+      // Complete events ("X" phase), with microsecond timestamps.
+      std::fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f",
+                   (eventCnt++ > 0)? ",\n" : "", event.name, buffer->tid, event.startNs / 1e3, event.durationNs / 1e3);
+      if (event.argName != nullptr) std::fprintf(file, ",\"args\":{\"%s\":%ld}", event.argName, event.argValue);
+      std::fputs("}", file);
+    }
+  }
+  std::fflush(file);
+}
+
+#endif
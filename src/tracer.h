@@ -0,0 +1,189 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include "profiler.h"
+
+/**
+ *  Timeline tracer, writing Chrome trace-event JSON files (viewable in Perfetto or chrome://tracing), only built if
+ * SNAKE_INSTRUMENTATION is defined. Otherwise, the TRACE_* macros expand to nothing.
+ */
+#ifdef SNAKE_INSTRUMENTATION
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+#include "mpscqueue.h"
+
+/**
+ *  \brief Class recording timed spans (e.g. frame phases, worker evaluations) into a trace file, while started. Each
+ * thread queues its spans into its own bounded lock-free buffer (created on its first span, and linked into a lock-free
+ * list), which a background thread drains into the file at regular intervals, so recording a span never blocks nor
+ * writes to the file. If a thread's buffer is full, its spans are dropped and counted instead.
+ */
+class Tracer {
+ public:
+  /**
+   *  \brief Timed span, recorded from its construction to its destruction (or to an earlier End call), if the tracer is
+   * started at construction time.
+   */
+  class Span {
+   public:
+    /**
+     *  \brief Constructor of the Span class object, starting the span.
+     *  \param name The span name (a string literal, as it's written out later).
+     *  \param argName Name of an integer argument shown with the span (a string literal), or nullptr for none.
+     *  \param argValue Value of the argument.
+     */
+    explicit Span(const char *name, const char *argName = nullptr, const long argValue = 0);
+    ~Span() { End(); }
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+    /**
+     *  \brief Ends the span before its destruction (only recorded once).
+     */
+    void End();
+
+   private:
+    const char *name;
+    const char *argName;
+    const long argValue;
+    bool active;
+    std::chrono::steady_clock::time_point start;
+  };
+
+  /**
+   *  \brief Opens the trace file and starts the writer thread (and the recording of spans). If the file can't be opened, a
+   * runtime exception is raised.
+   *  \param path The trace file path.
+   */
+  static void Start(const std::string& path);
+
+  /**
+   *  \brief Stops the recording of spans, writes the queued ones (along with the names of the threads), then stops the
+   * writer thread and closes the trace file. Does nothing if the tracer isn't started.
+   */
+  static void Stop();
+
+  /**
+   *  \brief Sets the name of the calling thread, shown on its timeline track.
+   *  \param name The thread name (a string literal).
+   */
+  static void SetThreadName(const char *name);
+
+  /**
+   *  \brief Returns whether spans are being recorded.
+   *  \return True, if the tracer is started; false, otherwise.
+   */
+  static bool IsEnabled() { return enabled.load(std::memory_order_acquire); }
+
+ private:
+  /**
+   *  \brief A recorded span, with its start time and duration in nanoseconds since the trace start.
+   */
+  struct Event {
+    const char *name;
+    const char *argName;
+    long argValue;
+    int64_t startNs;
+    int64_t durationNs;
+  };
+
+  /**
+   *  \brief Span buffer of a thread, with the thread's trace id and name, and the next thread's buffer in the list.
+   */
+  struct ThreadBuffer {
+    ThreadBuffer(const unsigned int tid);
+    MpscQueue<Event> queue;
+    const unsigned int tid;
+    std::atomic<const char*> name{nullptr};
+    std::atomic<unsigned long> droppedCnt{0};
+    ThreadBuffer *next{nullptr};
+  };
+
+  /**
+   *  \brief Returns the calling thread's span buffer, creating and linking it on the first call.
+   *  \return The thread's buffer.
+   */
+  static Tracer::ThreadBuffer& GetThreadBuffer();
+
+  /**
+   *  \brief Writer thread routine: writes the queued spans out at regular intervals, until the tracer is stopped.
+   */
+  static void Write();
+
+  /**
+   *  \brief Writes the queued spans of all threads to the trace file.
+   */
+  static void Drain();
+
+  /**
+   *  \brief Flag indicating if spans are being recorded, and flag requesting the writer thread to stop.
+   */
+  static std::atomic<bool> enabled;
+  static std::atomic<bool> stopping;
+
+  /**
+   *  \brief Head of the list of all threads' buffers (which are kept after their threads end), and the number of buffers.
+   */
+  static std::atomic<ThreadBuffer*> threadBuffersHead;
+  static std::atomic<unsigned int> threadCnt;
+
+  /**
+   *  \brief Time the trace started at.
+   */
+  static std::chrono::steady_clock::time_point startTime;
+
+  /**
+   *  \brief The trace file, and the number of events written to it.
+   */
+  static std::FILE *file;
+  static unsigned long eventCnt;
+
+  /**
+   *  \brief The writer thread.
+   */
+  static std::thread writer;
+};
+
+/**
+ *  \brief Records the rest of the enclosing scope as a span (e.g. "TRACE_SCOPE("render");"), optionally with an integer
+ * argument (e.g. "TRACE_SCOPE_ARG("evaluate", "individual", idx);").
+ */
+#define TRACE_SCOPE(name) Tracer::Span PROFILE_CONCAT(traceSpan, __LINE__)(name)
+#define TRACE_SCOPE_ARG(name, argName, argValue) Tracer::Span PROFILE_CONCAT(traceSpan, __LINE__)(name, argName, argValue)
+
+/**
+ *  \brief Starts a named span variable, ended explicitly by TRACE_SPAN_END (or at the end of its scope).
+ */
+#define TRACE_SPAN(var, name) Tracer::Span var(name)
+#define TRACE_SPAN_END(var) var.End()
+
+/**
+ *  \brief Names the calling thread in the trace.
+ */
+#define TRACE_THREAD_NAME(name) Tracer::SetThreadName(name)
+
+/**
+ *  \brief Starts and stops the tracer.
+ */
+#define TRACE_START(path) Tracer::Start(path)
+#define TRACE_STOP() Tracer::Stop()
+
+#else
+
+#define TRACE_SCOPE(name)
+#define TRACE_SCOPE_ARG(name, argName, argValue)
+#define TRACE_SPAN(var, name)
+#define TRACE_SPAN_END(var)
+#define TRACE_THREAD_NAME(name)
+#define TRACE_START(path)
+#define TRACE_STOP()
+
+#endif
+
+#endif
@@ -0,0 +1,191 @@
+#include "trainer.h"
+#include <algorithm>
+#include <chrono>
+#include "config.h"
+#include "tracer.h"
+#include "allocstats.h"
+
+/**
+ *  \brief Number of worker game steps run between checks of the worker time slice.
+ */
+#define TRAINER_STEPS_PER_CHECK 256
+
+Trainer::Trainer(const unsigned int workerCnt, const unsigned int gridSideLen, std::shared_ptr<GenAlg> genalg,
+                 EventLog *eventLog)
+  : genalg(genalg), eventLog(eventLog), seedGenerator(std::chrono::system_clock::now().time_since_epoch().count()) {
+  // By default, use the hardware threads not used by the game's main and simulation threads.
+  const unsigned int hardwareCnt = std::thread::hardware_concurrency();
+  const unsigned int cnt = (workerCnt > 0)? workerCnt : std::max((hardwareCnt > 2)? hardwareCnt - 2 : 0, (unsigned int) 1);
+
+  // Each worker has its own world and snake, with the snake starting at the world center.
+  for (unsigned int i = 0; i < cnt; i++) {
+    worlds.push_back(std::make_unique<World>(gridSideLen));
+    snakes.push_back(std::make_unique<Snake>(SDL_Point{(int) gridSideLen/2, (int) gridSideLen/2}, *worlds.back(), genalg));
+    snakes.back()->SetAutoMode(true);
+  }
+  for (unsigned int i = 0; i < cnt; i++) workers.emplace_back(&Trainer::Work, this, i);
+}
+
+Trainer::~Trainer() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+    active = false;
+    epoch++;
+  }
+  workAvailable.notify_all();
+  for (std::thread& worker : workers) worker.join();
+}
+
+void Trainer::Resume(const bool throttled) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->throttled = throttled;
+    if (active) return;
+
+    // Start claiming individuals from the genetic algorithm's current one. The best individual of the current generation
+    // is searched anew, as the generation may have been graded elsewhere meanwhile.
+    epoch++;
+    claimedCnt = 0;
+    results.clear();
+    generationBestKnown = false;
+    generationCnt = genalg->GetGenerationCnt();
+    individualCnt = genalg->GetIndividualCnt();
+    active = true;
+  }
+  workAvailable.notify_all();
+}
+
+void Trainer::Pause() {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!active) return;
+
+  // Discard the claims in progress: their individuals stay pending in the genetic algorithm, to be evaluated again.
+  active = false;
+  epoch++;
+  claimedCnt = 0;
+  results.clear();
+}
+
+void Trainer::Work(const unsigned int workerIdx) {
+  using Clock = std::chrono::steady_clock;
+  World& world = *worlds[workerIdx];
+  Snake& snake = *snakes[workerIdx];
+  const Clock::duration slice = std::chrono::microseconds(BACKGROUND_TRAINING_SLICE_US);
+  const double idleRatio = (1.0 - BACKGROUND_TRAINING_DUTY_CYCLE) / BACKGROUND_TRAINING_DUTY_CYCLE;
+
+  TRACE_THREAD_NAME("trainer worker");
+  Trainer::Claim claim;
+  while (ClaimIndividual(claim)) {
+    TRACE_SCOPE_ARG("evaluate", "individual", claim.individual);
+    ALLOC_SCOPE(gameAllocs);
+
+    // Play a whole game round with the claimed individual, as done by the game in auto mode (with no lookahead search), in
+    // a world seeded for the round to be replayable.
+    world.Init(claim.seed);
+    snake.Init(claim.chromosome);
+    Clock::time_point sliceStart = Clock::now();
+    unsigned long steps = 0;
+    bool discarded = false;
+    while (snake.IsAlive() && world.HasFood()) {
+      snake.Update();
+
+      if (++steps % TRAINER_STEPS_PER_CHECK == 0) {
+        // Give up the evaluation if the training was paused meanwhile.
+        if (epoch != claim.epoch) {
+          discarded = true;
+          break;
+        }
+
+        // After working for a whole time slice, sleep in proportion to it, so that the worker keeps its duty cycle.
+        const Clock::duration worked = Clock::now() - sliceStart;
+        if (throttled && worked >= slice) {
+          std::this_thread::sleep_for(std::chrono::duration_cast<Clock::duration>(worked * idleRatio));
+          sliceStart = Clock::now();
+        }
+      }
+    }
+    if (discarded) continue;
+
+    // Set the fitness as equal to the snake size.
+    if (SubmitFitness(claim.ticket, claim.epoch, (float) snake.GetSize(), claim.seed) && eventLog != nullptr) {
+      eventLog->LogGame(EventLog::Source::Trainer, snake, claim.generation, claim.individual);
+    }
+    ALLOC_RECORD(Game, gameAllocs);
+  }
+}
+
+bool Trainer::ClaimIndividual(Trainer::Claim& claim) {
+  std::unique_lock<std::mutex> lock(mutex);
+
+  // Individuals can only be claimed up to the end of the current generation, as the next one is only generated once all
+  // of them are graded.
+  workAvailable.wait(lock, [this]() { return stopping || (active && claimedCnt < genalg->GetPendingCnt()); });
+  if (stopping) return false;
+
+  claim.ticket = gradedCnt + claimedCnt;
+  claim.epoch = epoch;
+  claim.chromosome = genalg->GetPendingIndividual(claimedCnt);
+  claim.seed = (unsigned int) seedGenerator();
+  claim.generation = genalg->GetGenerationCnt();
+  claim.individual = genalg->GetIndividualCnt() + claimedCnt;
+  claimedCnt++;
+  results.push_back(Result{false, 0.0f, claim.seed});
+  return true;
+}
+
+bool Trainer::SubmitFitness(const unsigned long ticket, const unsigned long claimEpoch, const float fitness, 
+                            const unsigned int seed) {
+  bool graded = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!active || claimEpoch != epoch) return false;
+
+    // Keep track of the maximum score (i.e. snake size increase), only once the round is known to belong to the current
+    // epoch (so that a round discarded by a pause, e.g. before a data reset, can't restore an erased record).
+    maxScore = std::max<unsigned int>(maxScore, (unsigned int) fitness - 1);
+
+    // Record the fitness, then grade the genetic algorithm's current individual for as long as its fitness is known.
+    results[ticket - gradedCnt] = Result{true, fitness, seed};
+    while (!results.empty() && results.front().known) {
+      const Result& result = results.front();
+      const unsigned int generation = genalg->GetGenerationCnt();
+
+      // Keep track of the generation's best individual (only copied when it improves), which becomes the champion once 
+      // the whole generation is graded.
+      if (!generationBestKnown || result.fitness > generationBest.fitness) {
+        generationBest = Trainer::Champion{genalg->GetCurIndividual(), result.seed, result.fitness, generation};
+        generationBestKnown = true;
+      }
+      genalg->GradeCurFitness(result.fitness);
+      if (genalg->GetGenerationCnt() != generation) {
+        champion = generationBest;
+        championKnown = true;
+        generationBestKnown = false;
+      }
+
+      results.pop_front();
+      claimedCnt--;
+      gradedCnt++;
+      graded = true;
+    }
+    generationCnt = genalg->GetGenerationCnt();
+    individualCnt = genalg->GetIndividualCnt();
+  }
+
+  // A new generation may have started, whose individuals can be claimed.
+  if (graded) workAvailable.notify_all();
+  return true;
+}
+
+bool Trainer::GetChampion(Trainer::Champion& champion) {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (championKnown) champion = this->champion;
+  return championKnown;
+}
+
+void Trainer::ResetChampion() {
+  std::lock_guard<std::mutex> lock(mutex);
+  championKnown = false;
+  generationBestKnown = false;
+}
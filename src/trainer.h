@@ -0,0 +1,279 @@
+#ifndef TRAINER_H
+#define TRAINER_H
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <random>
+
+#include "world.h"
+#include "snake.h"
+#include "genalg.h"
+#include "eventlog.h"
+
+/**
+ *  \brief Class training the snake AI in the background, with headless worker threads (i.e. with no rendering), while the
+ * game snake is controlled by the player. Each worker evaluates individuals of the current genetic algorithm generation
+ * in its own world, and their fitness is graded in the same order they were taken from the genetic algorithm.
+ * Workers are throttled to a fraction of the CPU time, so that the game keeps its frame budget.
+ */
+class Trainer {
+ public:
+  /**
+   *  \brief Best individual of a generation, with the seed of the world it was evaluated in, so that its game round can be
+   * replayed exactly (the snake AI decisions being deterministic).
+   */
+  struct Champion {
+    /**
+     *  \brief The individual/chromosome.
+     */
+    VectorXf chromosome;
+
+    /**
+     *  \brief Seed of the world random number generator, at the start of the individual's game round.
+     */
+    unsigned int seed{0};
+
+    /**
+     *  \brief The individual's fitness.
+     */
+    float fitness{0.0f};
+
+    /**
+     *  \brief The generation the individual belongs to.
+     */
+    unsigned int generation{0};
+  };
+
+  /**
+   *  \brief Constructor of the Trainer class object. The worker threads are started here, but stay idle until resumed.
+   *  \param workerCnt Number of worker threads (0 selects the number of hardware threads left by the game's main and
+   * simulation threads, at least one).
+   *  \param gridSideLen The side length of each worker's square world, in number of grid cells.
+   *  \param genalg The genetic algorithm whose individuals are evaluated.
+   *  \param eventLog Log of the finished games (or nullptr, for no logging).
+   */
+  Trainer(const unsigned int workerCnt, const unsigned int gridSideLen, std::shared_ptr<GenAlg> genalg,
+          EventLog *eventLog = nullptr);
+
+  /**
+   *  \brief Destructor of the Trainer class object. Stops and joins the worker threads.
+   */
+  ~Trainer();
+
+  /**
+   *  \brief Starts (or resumes) the background training, from the genetic algorithm's current individual.
+   *  \param throttled True, if the workers are throttled to the configured duty cycle (e.g. while the game is played); 
+   * false, if they run at full speed. Also applies if the training is already running.
+   */
+  void Resume(const bool throttled = true);
+
+  /**
+   *  \brief Pauses the background training. Once this returns, the workers don't access the genetic algorithm anymore
+   * (until resumed), and the evaluations in progress are discarded.
+   */
+  void Pause();
+
+  /**
+   *  \brief Indicates if the background training is running.
+   *  \return True, if the workers are evaluating individuals.
+   */
+  bool IsActive() const { return active; }
+
+  /**
+   *  \brief Returns the genetic algorithm's generation count, as of the latest graded individual.
+   *  \return The current generation number.
+   */
+  unsigned int GetGenerationCnt() const { return generationCnt; }
+
+  /**
+   *  \brief Returns the genetic algorithm's individual count, as of the latest graded individual.
+   *  \return The index of the next individual to be graded.
+   */
+  unsigned int GetIndividualCnt() const { return individualCnt; }
+
+  /**
+   *  \brief Returns the maximum score achieved by the workers' snakes since the latest reset.
+   *  \return Maximum score, in points.
+   */
+  unsigned int GetMaxScore() const { return maxScore; }
+
+  /**
+   *  \brief Clears the maximum score achieved by the workers' snakes.
+   */
+  void ResetMaxScore() {
+    std::lock_guard<std::mutex> lock(mutex);
+    maxScore = 0;
+  }
+
+  /**
+   *  \brief Returns the best individual of the latest generation fully graded by the trainer.
+   *  \param champion Output parameter set with a copy of the champion, if there's one.
+   *  \return True, if a generation was fully graded since the latest champion reset; false, otherwise.
+   */
+  bool GetChampion(Trainer::Champion& champion);
+
+  /**
+   *  \brief Discards the current champion (e.g. once the genetic algorithm is reset).
+   */
+  void ResetChampion();
+
+ private:
+  /**
+   *  \brief Claim of an individual by a worker, to be evaluated.
+   */
+  struct Claim {
+    /**
+     *  \brief Copy of the claimed individual/chromosome.
+     */
+    VectorXf chromosome;
+
+    /**
+     *  \brief The claim ticket, i.e. the individual's position in the grading order, and the training epoch it belongs to.
+     */
+    unsigned long ticket;
+    unsigned long epoch;
+
+    /**
+     *  \brief Seed of the world the individual shall be evaluated in.
+     */
+    unsigned int seed;
+
+    /**
+     *  \brief The individual's generation, and its index in the generation.
+     */
+    unsigned int generation;
+    unsigned int individual;
+  };
+
+  /**
+   *  \brief Worker thread routine: evaluates individuals, one game round each, until the trainer is destroyed.
+   *  \param workerIdx Index of the worker, selecting its world and snake.
+   */
+  void Work(const unsigned int workerIdx);
+
+  /**
+   *  \brief Waits until an individual is pending evaluation (and not claimed by another worker) while training, and claims it.
+   *  \param claim Output parameter set with the claim.
+   *  \return True, if an individual was claimed; false, if the trainer is being destroyed.
+   */
+  bool ClaimIndividual(Trainer::Claim& claim);
+
+  /**
+   *  \brief Submits the fitness of a claimed individual, and grades every individual whose fitness is known, in order.
+   * The fitness is discarded if the training was paused since the individual was claimed.
+   *  \param ticket The claim ticket.
+   *  \param claimEpoch The training epoch of the claim.
+   *  \param fitness The individual's fitness.
+   *  \param seed The seed of the world the individual was evaluated in.
+   *  \return True, if the fitness was recorded; false, if it was discarded.
+   */
+  bool SubmitFitness(const unsigned long ticket, const unsigned long claimEpoch, const float fitness, 
+                     const unsigned int seed);
+
+  /**
+   *  \brief The genetic algorithm whose individuals are evaluated, only accessed with the mutex locked.
+   */
+  std::shared_ptr<GenAlg> genalg;
+
+  /**
+   *  \brief Log of the finished games (or nullptr, for no logging).
+   */
+  EventLog *eventLog;
+
+  /**
+   *  \brief Worlds and snakes of the workers, one of each per worker.
+   */
+  std::vector<std::unique_ptr<World>> worlds;
+  std::vector<std::unique_ptr<Snake>> snakes;
+
+  /**
+   *  \brief The worker threads.
+   */
+  std::vector<std::thread> workers;
+
+  /**
+   *  \brief Mutex protecting the genetic algorithm and the claims.
+   */
+  std::mutex mutex;
+
+  /**
+   *  \brief Condition notified whenever individuals may have become available to be claimed (or the trainer is stopping).
+   */
+  std::condition_variable workAvailable;
+
+  /**
+   *  \brief Flag indicating if the background training is running.
+   */
+  std::atomic<bool> active{false};
+
+  /**
+   *  \brief Flag indicating if the workers are throttled to the configured duty cycle.
+   */
+  std::atomic<bool> throttled{true};
+
+  /**
+   *  \brief Flag indicating if the trainer is being destroyed.
+   */
+  bool stopping{false};
+
+  /**
+   *  \brief Training epoch, incremented whenever the training is paused or resumed (invalidating the claims in progress).
+   */
+  std::atomic<unsigned long> epoch{0};
+
+  /**
+   *  \brief Number of individuals claimed but not graded yet, from the genetic algorithm's current one.
+   */
+  unsigned int claimedCnt{0};
+
+  /**
+   *  \brief Total number of individuals graded by the trainer, which is the ticket of the next individual to be graded.
+   */
+  unsigned long gradedCnt{0};
+
+  /**
+   *  \brief Result of a claimed individual's evaluation.
+   */
+  struct Result {
+    bool known;
+    float fitness;
+    unsigned int seed;
+  };
+
+  /**
+   *  \brief Results of the claimed individuals, in grading order.
+   */
+  std::deque<Result> results;
+
+  /**
+   *  \brief Random number generator of the worlds' seeds. Initialized in class constructor with the system clock as a seed.
+   */
+  std::default_random_engine seedGenerator;
+
+  /**
+   *  \brief Best individual graded so far in the genetic algorithm's current generation, and the best one of the latest 
+   * fully graded generation (only valid if the respective flags are set).
+   */
+  Trainer::Champion generationBest;
+  Trainer::Champion champion;
+  bool generationBestKnown{false};
+  bool championKnown{false};
+
+  /**
+   *  \brief Genetic algorithm progress, as of the latest graded individual, readable without locking the mutex.
+   */
+  std::atomic<unsigned int> generationCnt{0};
+  std::atomic<unsigned int> individualCnt{0};
+
+  /**
+   *  \brief Maximum score achieved by the workers' snakes (only written under the mutex, and read with no lock).
+   */
+  std::atomic<unsigned int> maxScore{0};
+};
+
+#endif
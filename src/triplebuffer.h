@@ -0,0 +1,87 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <array>
+#include <atomic>
+
+/**
+ *  \brief Lock-free triple buffer, used to hand the latest value over from a single writer thread to a single reader thread.
+ * The writer fills its back buffer and publishes it, while the reader consumes the latest published buffer. Neither side
+ * ever waits for the other: the writer may publish faster than the reader consumes (in which case unread values are
+ * dropped), and the reader keeps its current buffer until a newer one is published.
+ */
+template<typename T>
+class TripleBuffer {
+ public:
+  /**
+   *  \brief Returns the back buffer, which only the writer thread may access, to be filled before being published.
+   *  \return Reference to the back buffer.
+   */
+  T& GetBackBuffer() { return buffers[backIdx]; }
+
+  /**
+   *  \brief Returns the index of the back buffer (from 0 to 2), e.g. for the writer to keep its own state per buffer.
+   *  \return The back buffer index.
+   */
+  unsigned int GetBackIndex() const { return backIdx; }
+
+  /**
+   *  \brief Publishes the back buffer, making it the latest value available to the reader (writer thread only).
+   * The writer then gets a new back buffer, which holds an older value.
+   *  \return True, if the previously published value was dropped without ever being consumed by the reader.
+   */
+  bool Publish() {
+    const unsigned int prior = middle.exchange(backIdx | FRESH_FLAG, std::memory_order_acq_rel);
+    backIdx = prior & INDEX_MASK;
+    return (prior & FRESH_FLAG) != 0;
+  }
+
+  /**
+   *  \brief Takes the latest published value as the front buffer, if a new one is available (reader thread only).
+   *  \return True, if a new value was consumed; false, if the front buffer is still the latest published value.
+   */
+  bool Consume() {
+    if ((middle.load(std::memory_order_relaxed) & FRESH_FLAG) == 0) return false;
+    frontIdx = middle.exchange(frontIdx, std::memory_order_acq_rel) & INDEX_MASK;
+    return true;
+  }
+
+  /**
+   *  \brief Returns the front buffer, which only the reader thread may access.
+   *  \return Const reference to the front buffer, holding the latest consumed value.
+   */
+  const T& GetFrontBuffer() const { return buffers[frontIdx]; }
+
+ private:
+  /**
+   *  \brief Flag set on the middle buffer index while it holds a value not consumed by the reader yet.
+   */
+  static constexpr unsigned int FRESH_FLAG = 0x4;
+
+  /**
+   *  \brief Mask extracting the buffer index from the middle buffer index and flag.
+   */
+  static constexpr unsigned int INDEX_MASK = 0x3;
+
+  /**
+   *  \brief The three buffers, each one owned by the writer (back), the reader (front), or none of them (middle) at a time.
+   */
+  std::array<T,3> buffers;
+
+  /**
+   *  \brief Index of the back buffer, owned by the writer thread.
+   */
+  unsigned int backIdx{0};
+
+  /**
+   *  \brief Index of the middle buffer, exchanged between the threads, together with the fresh value flag.
+   */
+  std::atomic<unsigned int> middle{1};
+
+  /**
+   *  \brief Index of the front buffer, owned by the reader thread.
+   */
+  unsigned int frontIdx{2};
+};
+
+#endif
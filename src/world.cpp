@@ -1,48 +1,106 @@
 #include "world.h"
 #include "clip.h"
+#include "profiler.h"
 #include <stdexcept>
 #include <chrono>
 #include <string>
+#include <algorithm>
 
-World::World(const unsigned int gridSideLen) :
+/**
+ *  \brief Maximum number of random cells tried when placing a food, before falling back to a scan of the grid free cells.
+ * As long as the grid isn't crowded, a free cell is found in a few attempts, regardless of the grid area.
+ */
+#define FOOD_PLACEMENT_ATTEMPTS 32
+
+World::World(const unsigned int gridSideLen, const unsigned int foodCnt) :
     gridSideLen(gridSideLen),
+    foods(std::max(foodCnt, (unsigned int) 1), Food{{0,0}, false}),
     randGenerator(std::chrono::system_clock::now().time_since_epoch().count()) {
   // Initialize the world grid and food.
   Init();
 }
 
 void World::Init() {
+  // Previous snapshots don't apply to the re-initialized world.
+  ReleaseSnapshots();
+
   // Initialize world grid/map.
   InitWorldGrid();
 
-  // Initialize the food.
-  if (GrowFood()) return;
-  else throw std::runtime_error("World grid with no position available to initialize food.");
+  // Initialize the foods.
+  for (unsigned int i = 0; i < foods.size(); i++) {
+    if (!GrowFood(i)) throw std::runtime_error("World grid with no position available to initialize food.");
+  }
 }
 
-bool World::GrowFood() {
+void World::Init(const unsigned int seed) {
+  randGenerator.seed(seed);
+  Init();
+}
+
+bool World::GrowFood(const unsigned int foodIdx) {
+  PROFILE_SCOPE(GrowFood);
+
+  // If there's any snapshot to be restored later, record the prior food state.
+  if (journaling) foodJournal.push_back({foodIdx, foods[foodIdx]});
+
   // Place the food only in an available (non-occupied) location in the grid.
-  if (!freeGridPositions.empty()) {
-    // Select a random index from the free grid positions map.
-    std::uniform_int_distribution<int> randomPosition{0, static_cast<int>(freeGridPositions.size()) - 1};
-    int randIndex = randomPosition(randGenerator);
-    std::unordered_map<World::Element*,SDL_Point>::iterator it = freeGridPositions.begin();
-    std::advance(it,randIndex);
+  if (freeCellsCnt > 0) {
+    // First, try to pick a random grid cell directly, until an empty one is found.
+    std::uniform_int_distribution<std::size_t> randomCell{0, grid.size() - 1};
+    std::size_t cell = grid.size();
+    for (int i = 0; i < FOOD_PLACEMENT_ATTEMPTS && cell == grid.size(); i++) {
+      std::size_t candidate = randomCell(randGenerator);
+      if (grid[candidate] == Element::None) cell = candidate;
+    }
+
+    // If the grid is too crowded for that, select a random index among the free cells and scan the grid for it.
+    if (cell == grid.size()) {
+      std::uniform_int_distribution<std::size_t> randomFreeCell{0, freeCellsCnt - 1};
+      std::size_t freeCellIdx = randomFreeCell(randGenerator);
+      for (cell = 0; cell < grid.size(); cell++) {
+        if (grid[cell] == Element::None) {
+          if (freeCellIdx == 0) break;
+          freeCellIdx--;
+        }
+      }
+    }
 
     // Initialize the food at the randomly selected empty grid spot.
-    this->food = it->second;
-    SetElement(food, Element::Food);
+    foods[foodIdx].position = SDL_Point{(int) (cell % gridSideLen), (int) (cell / gridSideLen)};
+    SetElement(foods[foodIdx].position, Element::Food);
 
-    return true;
+    foods[foodIdx].placed = true;
   }
-  else return false;
+  else foods[foodIdx].placed = false;
+
+  return foods[foodIdx].placed;
+}
+
+void World::PlaceFood(const SDL_Point& position, const unsigned int foodIdx) {
+  // If there's any snapshot to be restored later, record the prior food state.
+  if (journaling) foodJournal.push_back({foodIdx, foods[foodIdx]});
+
+  // Remove the food from its previous location, unless something else took that tile over since then.
+  if (foods[foodIdx].placed && GetElement(foods[foodIdx].position) == Element::Food) {
+    SetElement(foods[foodIdx].position, Element::None);
+  }
+  SetElement(position, Element::Food);
+  foods[foodIdx] = Food{position, true};
+}
+
+unsigned int World::GetFoodIndexAt(const SDL_Point& position) const {
+  for (unsigned int i = 0; i < foods.size(); i++) {
+    if (foods[i].placed && foods[i].position == position) return i;
+  }
+  return 0;
 }
 
 bool World::IsObstacle(const SDL_Point& position) const {
   // First check if position is inside the world grid boundaries. Otherwise, already return true.
   if (IsInsideBoundaries(position)) {
     // If inside grid boundaries, check if position is already filled with a collidable element. Return false otherwise.
-    switch (GetElement(position)) {
+    switch (grid[(std::size_t) position.y * gridSideLen + position.x]) {
       case Element::SnakeBody:
       case Element::AliveSnakeHead:
       case Element::DeadSnakeHead:
@@ -57,74 +115,126 @@ bool World::IsObstacle(const SDL_Point& position) const {
 void World::SetElement(const SDL_Point& position, const World::Element element) {
   // Check if position is inside grid boundaries first. If it isn't, raise a runtime exception.
   if (IsInsideBoundaries(position)) {
-    grid[position.y][position.x] = element;
-    if (element != Element::None) {
-      auto searchResult = freeGridPositions.find(&grid[position.y][position.x]);
-      if (searchResult != freeGridPositions.end()) {
-        // If position is present in the free grid positions list, remove it (as it's no longer free).
-        freeGridPositions.erase(searchResult);
-      }
-    } else {
-      // If the position holds no element, make sure it is present in the free positions container.
-      freeGridPositions.insert({&grid[position.y][position.x], position}); 
-    }
+    // If there's any snapshot to be restored later, record the prior tile content.
+    if (journaling) journal.push_back({position, grid[(std::size_t) position.y * gridSideLen + position.x]});
+    WriteElement(position, element);
   } else throw std::runtime_error("Out-of-boundaries world grid position (x = " + std::to_string(position.x) 
                                     + ", y = " + std::to_string(position.y) + ") trying to be set.");
 }
 
+void World::WriteElement(const SDL_Point& position, const World::Element element) {
+  const std::size_t cell = (std::size_t) position.y * gridSideLen + position.x;
+  WriteCell(cell, element);
+  if (!roundChangedFlags[cell]) {
+    roundChangedFlags[cell] = true;
+    roundChangedCells.push_back(cell);
+  }
+}
+
+void World::WriteCell(const std::size_t cell, const World::Element element) {
+  // Keep the free cells count up to date, in case the cell is being freed or occupied.
+  if (grid[cell] == Element::None && element != Element::None) freeCellsCnt--;
+  else if (grid[cell] != Element::None && element == Element::None) freeCellsCnt++;
+  // Likewise for the snake cells count.
+  snakeCellsCnt += (std::size_t) IsSnakeElement(element);
+  snakeCellsCnt -= (std::size_t) IsSnakeElement(grid[cell]);
+  grid[cell] = element;
+
+  // List the tile as changed, unless it's already listed.
+  if (!changedTileFlags[cell]) {
+    changedTileFlags[cell] = true;
+    changedTiles.push_back(SDL_Point{(int) (cell % gridSideLen), (int) (cell / gridSideLen)});
+  }
+}
+
+void World::ClearChangedTiles() {
+  for (const SDL_Point& tile : changedTiles) changedTileFlags[(std::size_t) tile.y * gridSideLen + tile.x] = false;
+  changedTiles.clear();
+}
+
 World::Element World::GetElement(const SDL_Point& position) const { 
   if (IsInsideBoundaries(position)) {
     // If position is inside grid boundaries, return the element in that position.
-    return grid[position.y][position.x];
+    return grid[(std::size_t) position.y * gridSideLen + position.x];
   } else {
     // Else, throw an exception and return the element at the origin coordinate of the grid.
     throw std::runtime_error("Out-of-boundaries world grid position (x = " + std::to_string(position.x) 
                                     + ", y = " + std::to_string(position.y) + ") trying to be read.");
-    return grid[0][0];
+    return grid[0];
   }
 }
 
 World::Element& World::GetElementRef(const SDL_Point& position) { 
   if (IsInsideBoundaries(position)) {
     // If position is inside grid boundaries, return the element in that position.
-    return grid[position.y][position.x];
+    return grid[(std::size_t) position.y * gridSideLen + position.x];
   } else {
     // Else, throw an exception and return the element at the origin coordinate of the grid.
     throw std::runtime_error("Out-of-boundaries world grid position (x = " + std::to_string(position.x) 
                                     + ", y = " + std::to_string(position.y) + ") trying to be read.");
-    return grid[0][0];
+    return grid[0];
   }
 }
 
-void World::InitWorldGrid() {
-  // Clear the current world grid elements.
-  freeGridPositions.clear();
-  grid.clear();
-
-  // Initialize the world grid.
-  grid.insert(grid.begin(), gridSideLen, std::vector<World::Element>(gridSideLen));
-  
-  // Initialize world grid cells as empty/free.
-  for (int row = 0; row < gridSideLen; row++) {
-    for (int col = 0; col < gridSideLen; col++) {
-      grid[row][col] = World::Element::None;
-      freeGridPositions[&grid[row][col]] = {col,row};
-    }
-  }
+World::Snapshot World::TakeSnapshot() {
+  journaling = true;
+  return Snapshot{journal.size(), foodJournal.size(), randGenerator};
+}
 
-  // Initialize the world walls at the borders of the grid.
-  for (int x = 0, y = 0; x < gridSideLen; x++) {
-    SetElement({x,y}, Element::Wall);
-  }
-  for (int x = 0, y = gridSideLen - 1; x < gridSideLen; x++) {
-    SetElement({x,y}, Element::Wall);
+void World::RestoreSnapshot(const Snapshot& snapshot) {
+  // Undo the grid changes from the latest to the oldest one, until the journal is back to the snapshot length.
+  while (journal.size() > snapshot.journalSize) {
+    const JournalEntry& entry = journal.back();
+    WriteElement(entry.position, entry.priorElement);
+    journal.pop_back();
   }
-  for (int x = 0, y = 0; y < gridSideLen; y++) {
-    SetElement({x,y}, Element::Wall);
+
+  // Undo the food changes in the same way.
+  while (foodJournal.size() > snapshot.foodJournalSize) {
+    const FoodJournalEntry& entry = foodJournal.back();
+    foods[entry.foodIdx] = entry.priorFood;
+    foodJournal.pop_back();
   }
-  for (int x = gridSideLen - 1, y = 0; y < gridSideLen; y++) {
-    SetElement({x,y}, Element::Wall);
+
+  // Restore the remaining world state.
+  randGenerator = snapshot.randGenerator;
+}
+
+void World::ReleaseSnapshots() {
+  journaling = false;
+  journal.clear();
+  foodJournal.clear();
+}
+
+World::Element World::GetInitialElement(const std::size_t cell) const {
+  // The world walls are located at the borders of the grid.
+  const std::size_t x = cell % gridSideLen;
+  const std::size_t y = cell / gridSideLen;
+  if (x == 0 || y == 0 || x == gridSideLen - 1 || y == gridSideLen - 1) return Element::Wall;
+  else return Element::None;
+}
+
+void World::InitWorldGrid() {
+  const std::size_t area = (std::size_t) gridSideLen * gridSideLen;
+
+  if (grid.size() != area) {
+    // At the first initialization, build the whole grid, with walls at its borders and empty/free cells elsewhere.
+    grid.assign(area, Element::None);
+    roundChangedFlags.assign(area, false);
+    changedTileFlags.assign(area, false);
+    changedTiles.clear();
+    freeCellsCnt = area;
+    snakeCellsCnt = 0;
+    for (std::size_t cell = 0; cell < area; cell++) WriteCell(cell, GetInitialElement(cell));
+  } else {
+    // Afterwards, only reset the cells changed since the previous initialization.
+    for (const std::size_t cell : roundChangedCells) {
+      WriteCell(cell, GetInitialElement(cell));
+      roundChangedFlags[cell] = false;
+    }
   }
+
+  roundChangedCells.clear();
 }
 
 bool World::IsInsideBoundaries(const SDL_Point& position) const {
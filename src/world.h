@@ -2,7 +2,8 @@
 #define WORLD_H
 
 #include <random>
-#include <unordered_map>
+#include <vector>
+#include <cstdint>
 #include <deque>
 
 #include "controller.h"
@@ -18,30 +19,95 @@ class World {
   /**
    *  \brief Enum type representing the possible contents of a tile in the world grid.
    */
-  enum class Element { None, AliveSnakeHead, DeadSnakeHead, SnakeBody, Wall, Food};
+  enum class Element : uint8_t { None, AliveSnakeHead, DeadSnakeHead, SnakeBody, Wall, Food};
 
   /**
-   *  \brief Constructor of the World class. The world is initialized with its walls and a food.
+   *  \brief Lightweight snapshot of the world state. Instead of copying the grid, it records the length of the world's 
+   * journal of grid changes at the time it was taken, so that restoring it only undoes the cells changed since then.
+   */
+  struct Snapshot {
+    /**
+     *  \brief Number of grid changes in the journal when the snapshot was taken.
+     */
+    std::size_t journalSize;
+
+    /**
+     *  \brief Number of food changes in the food journal when the snapshot was taken.
+     */
+    std::size_t foodJournalSize;
+
+    /**
+     *  \brief The random number generator state when the snapshot was taken.
+     */
+    std::default_random_engine randGenerator;
+  };
+
+  /**
+   *  \brief Constructor of the World class. The world is initialized with its walls and foods.
    *  \param gridSideLen The square world's width/height, in number of grid cells.
+   *  \param foodCnt Number of foods simultaneously present in the world (e.g. one per snake, in a shared world).
    */
-  World(const unsigned int gridSideLen);
+  World(const unsigned int gridSideLen, const unsigned int foodCnt = 1);
 
   /**
-   *  \brief Clean and re-initializes the world grid and the food in it.
+   *  \brief Clean and re-initializes the world grid and the foods in it.
    */
   void Init();
 
+  /**
+   *  \brief Clean and re-initializes the world grid and the foods in it, with the random number generator reseeded first, so
+   * that the same seed reproduces the same food placements (e.g. to replay a game round).
+   *  \param seed The random number generator seed.
+   */
+  void Init(const unsigned int seed);
+
   /**
    *  \brief Places a new food in the world, in an available empty location.
+   *  \param foodIdx Index of the food to be (re)placed.
    *  \return True, if a food was able to be placed in the world; false, if no empty grid cell was available.
    */
-  bool GrowFood();
+  bool GrowFood(const unsigned int foodIdx = 0);
+
+  /**
+   *  \brief Places a food at a specific empty location, removing it from its previous one (e.g. to resume a recorded game
+   * round). If the position is outside grid boundaries, a runtime exception is raised.
+   *  \param position The food position.
+   *  \param foodIdx Index of the food to be (re)placed.
+   */
+  void PlaceFood(const SDL_Point& position, const unsigned int foodIdx = 0);
 
   /**
-   *  \brief Returns a const reference to the current food position in the world.
+   *  \brief Returns a const reference to the current position of a food in the world.
+   *  \param foodIdx Index of the food.
    *  \return Reference to current food position.
    */
-  inline const SDL_Point& GetFoodPosition() const { return food; }
+  inline const SDL_Point& GetFoodPosition(const unsigned int foodIdx = 0) const { return foods[foodIdx].position; }
+
+  /**
+   *  \brief Indicates if a food is present in the world, i.e. if the latest GrowFood call for it was able to place it.
+   *  \param foodIdx Index of the food.
+   *  \return True, if the food is in the world; false, if the grid had no empty cell left for it.
+   */
+  inline bool HasFood(const unsigned int foodIdx = 0) const { return foods[foodIdx].placed; }
+
+  /**
+   *  \brief Returns the index of the food located at the input position.
+   *  \param position The food position.
+   *  \return The food index, or 0 if there's no placed food at the position.
+   */
+  unsigned int GetFoodIndexAt(const SDL_Point& position) const;
+
+  /**
+   *  \brief Returns the number of foods simultaneously present in the world.
+   *  \return Food count.
+   */
+  inline unsigned int GetFoodCount() const { return foods.size(); }
+
+  /**
+   *  \brief Returns the length of the world grid side.
+   *  \return The square world's width/height, in number of grid cells.
+   */
+  inline unsigned int GetGridSideLen() const { return gridSideLen; }
 
   /**
    *  \brief Returns a boolean indicating if there's an obstacle (e.g. wall, snake part or out-of-world-grid-boundaries) 
@@ -50,6 +116,14 @@ class World {
    */
   bool IsObstacle(const SDL_Point& position) const;
 
+  /**
+   *  \brief Returns the number of grid tiles holding a snake part (i.e. the tiles of all snakes sharing the world). As the
+   * walls are only located at the grid borders, a snake alone in the world (i.e. whose size equals this count) can tell
+   * its distances to the obstacles from its own positions, with no need to walk the grid.
+   *  \return Number of snake tiles.
+   */
+  inline std::size_t GetSnakeCellCnt() const { return snakeCellsCnt; }
+
   /**
    *  \brief Updates the element located in a specific world grid tile. 
    * If the position is outside grid boundaries, a runtime exception is raised.
@@ -74,9 +148,132 @@ class World {
    */
   World::Element& GetElementRef(const SDL_Point& position);
 
+  /**
+   *  \brief Returns the whole world grid, e.g. to be copied for rendering.
+   *  \return Const reference to the grid elements, in row-major order (i.e. position (x,y) at index y * gridSideLen + x).
+   */
+  inline const std::vector<Element>& GetGrid() const { return grid; }
+
+  /**
+   *  \brief Returns the grid tiles changed since the change list was last cleared (each one listed once), e.g. so that only
+   * those tiles need to be redrawn.
+   *  \return Const reference to the list of changed tile positions.
+   */
+  inline const std::vector<SDL_Point>& GetChangedTiles() const { return changedTiles; }
+
+  /**
+   *  \brief Empties the list of changed grid tiles, e.g. after they have been redrawn.
+   */
+  void ClearChangedTiles();
+
+  /**
+   *  \brief Takes a snapshot of the current world state and starts journaling every subsequent grid change, so that the
+   * snapshot can later be restored in time proportional to the number of changed cells.
+   * Several snapshots can be taken and restored (any number of times, e.g. to explore different branches of a game) 
+   * until ReleaseSnapshots is called.
+   *  \return The snapshot object.
+   */
+  Snapshot TakeSnapshot();
+
+  /**
+   *  \brief Restores the world to the state it had when the input snapshot was taken, by undoing the journaled grid changes
+   * done since then. The snapshot must not have been released.
+   *  \param snapshot The snapshot to be restored.
+   */
+  void RestoreSnapshot(const Snapshot& snapshot);
+
+  /**
+   *  \brief Invalidates all taken snapshots, stopping the grid changes journaling and discarding the journal.
+   */
+  void ReleaseSnapshots();
+
+  /**
+   *  \brief Indicates if there's any unreleased snapshot (i.e. if grid changes are being journaled).
+   *  \return True, if a snapshot has been taken and not released yet; false, otherwise.
+   */
+  inline bool HasSnapshots() const { return journaling; }
+
+  /**
+   *  \brief Returns the random number generator, whose state determines the next food placements (e.g. to be recorded).
+   *  \return Const reference to the random number generator.
+   */
+  inline const std::default_random_engine& GetRandGenerator() const { return randGenerator; }
+
+  /**
+   *  \brief Sets the random number generator state, e.g. to resume a recorded game round.
+   *  \param randGenerator The random number generator, in the state to be set.
+   */
+  inline void SetRandGenerator(const std::default_random_engine& randGenerator) { this->randGenerator = randGenerator; }
+
  private:
+  /**
+   *  \brief Entry of the grid changes journal, holding the element a grid tile contained before being changed.
+   */
+  struct JournalEntry {
+    SDL_Point position;
+    Element priorElement;
+  };
+
+  /**
+   *  \brief A food in the world.
+   */
+  struct Food {
+    /**
+     *  \brief The location of the food in the world grid.
+     */
+    SDL_Point position;
+
+    /**
+     *  \brief Indicates if the latest GrowFood call for this food was able to place it in the world.
+     */
+    bool placed;
+  };
+
+  /**
+   *  \brief Entry of the food changes journal, holding the state a food had before being changed.
+   */
+  struct FoodJournalEntry {
+    unsigned int foodIdx;
+    Food priorFood;
+  };
+
+  /**
+   *  \brief Writes an element to a grid tile (which shall be inside grid boundaries), updating the free cells count and
+   * recording the tile as changed in the current round, without journaling the change.
+   *  \param position The target position.
+   *  \param element The new element to be set at this position.
+   */
+  void WriteElement(const SDL_Point& position, const World::Element element);
+
+  /**
+   *  \brief Writes an element to a grid cell, updating the free and snake cells counts and the list of changed tiles
+   * accordingly.
+   *  \param cell Index of the cell in the grid vector.
+   *  \param element The new element to be set at this cell.
+   */
+  void WriteCell(const std::size_t cell, const World::Element element);
+
+  /**
+   *  \brief Checks if an element is a snake part (head or body, alive or dead).
+   *  \param element The element.
+   *  \return True, if the element is a snake part; false, otherwise.
+   */
+  static bool IsSnakeElement(const World::Element element) {
+    return element == Element::SnakeBody || element == Element::AliveSnakeHead || element == Element::DeadSnakeHead;
+  }
+
+  /**
+   *  \brief Returns the element a grid cell holds right after the world initialization (i.e. a wall at the grid borders,
+   * or no element otherwise).
+   *  \param cell Index of the cell in the grid vector.
+   *  \return The initial element.
+   */
+  World::Element GetInitialElement(const std::size_t cell) const;
+
   /**
    *  \brief Cleans and re-initializes the world grid.
+   * The whole grid is only built at the first initialization. Afterwards, only the cells changed since the previous 
+   * initialization are reset, so that the cost of starting a new round doesn't depend on the grid area.
    */
   void InitWorldGrid();
 
@@ -88,16 +285,41 @@ class World {
   bool IsInsideBoundaries(const SDL_Point& position) const;
 
   /**
-   *  \brief The world grid, indicating the world elements in matricial format.
+   *  \brief The world grid, indicating the world elements in a single contiguous vector, row by row (i.e. the element at
+   * position (x,y) is located at index y * gridSideLen + x).
+   */
+  std::vector<Element> grid;
+
+  /**
+   *  \brief Number of currently empty grid cells, used to know if and where a new food can be placed.
+   */
+  std::size_t freeCellsCnt{0};
+
+  /**
+   *  \brief Number of grid cells currently holding a snake part (head or body, alive or dead).
+   */
+  std::size_t snakeCellsCnt{0};
+
+  /**
+   *  \brief Indexes of the grid cells changed since the latest world initialization, which are the only ones that need to be
+   * reset at the next initialization.
+   */
+  std::vector<std::size_t> roundChangedCells;
+
+  /**
+   *  \brief Flags indicating which grid cells are already listed in roundChangedCells, so that each one is listed only once.
    */
-  std::vector<std::vector<Element>> grid;
+  std::vector<bool> roundChangedFlags;
 
   /**
-   *  \brief A container indicating all currently empty grid positions, indexed by the Element object address.
-   * The key value is the grid Element address, while the mapped value is the position in the grid, necessary
-   * to know where to initialize the food, when this map is used to assess the empty grid positions.
+   *  \brief Positions of the grid tiles changed since the change list was last cleared.
    */
-  std::unordered_map<Element*,SDL_Point> freeGridPositions;
+  std::vector<SDL_Point> changedTiles;
+
+  /**
+   *  \brief Flags indicating which grid cells are already listed in changedTiles, so that each one is listed only once.
+   */
+  std::vector<bool> changedTileFlags;
 
   /**
    *  \brief The length of the world grid side in number of cells.
@@ -105,14 +327,29 @@ class World {
   const unsigned int gridSideLen;
 
   /**
-   *  \brief The location of the food in the world grid.
+   *  \brief The foods in the world grid.
    */
-  SDL_Point food;
+  std::vector<Food> foods;
 
   /**
    *  \brief Random number generator. Initialized in class constructor with the system clock as a seed.
    */
   std::default_random_engine randGenerator;
+
+  /**
+   *  \brief Journal of grid changes done since the oldest unreleased snapshot, from the oldest to the latest change.
+   */
+  std::vector<JournalEntry> journal;
+
+  /**
+   *  \brief Journal of food changes done since the oldest unreleased snapshot, from the oldest to the latest change.
+   */
+  std::vector<FoodJournalEntry> foodJournal;
+
+  /**
+   *  \brief Indicates if grid changes are being journaled (i.e. if there's any unreleased snapshot).
+   */
+  bool journaling{false};
 };
 
 #endif
\ No newline at end of file